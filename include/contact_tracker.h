@@ -0,0 +1,63 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "iqs5xx_frame.h"
+
+// Contact tracker. The IQS5xx reorders its finger records when a contact
+// lifts, so record indices do not identify fingers across frames. The
+// tracker matches each frame's records to the contacts of the previous one
+// (nearest neighbour on squared distance) and keeps every contact in a fixed
+// slot with a stable ID, its movement since the last frame and a smoothed
+// velocity. Gesture handlers see the records reordered to slot order.
+
+// Records further than this from every known contact start a new contact (px)
+#define CONTACT_TRACKER_MAX_JUMP    256
+
+struct tracked_contact {
+    // Stable while the contact is down, 0 for a free slot
+    uint8_t id;
+    uint8_t area;
+    uint16_t strength;
+    uint16_t x;
+    uint16_t y;
+    // Movement since the previous frame (px)
+    int16_t dx;
+    int16_t dy;
+    // Smoothed velocity (px/s)
+    int16_t vx;
+    int16_t vy;
+};
+
+struct contact_tracker {
+    struct tracked_contact slots[IQS5XX_MAX_FINGERS];
+    // Slots of the current contacts, in slot order
+    uint8_t order[IQS5XX_MAX_FINGERS];
+    uint8_t count;
+    uint8_t next_id;
+    int64_t last_time;
+};
+
+/**
+ * @brief Associates the records of a frame with the tracked contacts
+ *
+ * @param tracker
+ * @param frame Frame as parsed
+ * @param now Frame time (ms)
+ * @param out Copy of the frame with the finger records in slot order
+ */
+void contact_tracker_update(struct contact_tracker *tracker, const struct iqs5xx_rawdata *frame,
+                            int64_t now, struct iqs5xx_rawdata *out);
+
+/**
+ * @brief Forgets all contacts, the next frame starts new ones
+ */
+void contact_tracker_reset(struct contact_tracker *tracker);
+
+/**
+ * @brief Returns the n-th current contact in slot order, matching out->fingers[n]
+ */
+static inline const struct tracked_contact *contact_tracker_get(const struct contact_tracker *tracker,
+                                                                uint8_t n) {
+    return &tracker->slots[tracker->order[n]];
+}
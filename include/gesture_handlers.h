@@ -1,23 +1,143 @@
 #pragma once
 
-#include <zephyr/device.h>
-#include <zephyr/kernel.h>
 #include <math.h>
 #include <string.h>
-#include "iqs5xx.h"
+#include "gesture_platform.h"
+#include "iqs5xx_frame.h"
+#include "gesture_math.h"
+#include "contact_tracker.h"
+#include "trackpad_profile.h"
 
-// Common gesture state and configuration
+// Two finger gesture types
+typedef enum {
+    TWO_FINGER_NONE = 0,
+    TWO_FINGER_ZOOM,
+    TWO_FINGER_VERTICAL_SCROLL,
+    TWO_FINGER_HORIZONTAL_SCROLL
+} two_finger_gesture_type_t;
+
+#ifdef CONFIG_IQS5XX_FIXED_POINT
+// Whole pixels for distances and movement, half pixels for scroll accumulators
+typedef int32_t tf_scalar_t;
+#else
+typedef float tf_scalar_t;
+#endif
+
+// Two finger session tracking (two_finger.c)
+struct two_finger_session {
+    // Basic tracking
+    bool active;
+    // Tracked contacts the session was started with
+    uint8_t contact_ids[2];
+    int64_t start_time;
+    two_finger_gesture_type_t gesture_type;
+    bool gesture_locked;
+
+    // Position tracking
+    struct {
+        uint16_t x, y;
+    } start_pos[2];
+    struct {
+        uint16_t x, y;
+    } last_pos[2];
+
+    // Zoom state
+    tf_scalar_t initial_distance;
+    tf_scalar_t last_distance;
+    bool zoom_command_sent;
+#ifdef CONFIG_IQS5XX_ZOOM_CONTINUOUS
+    // Spread at which the last zoom step was emitted
+    tf_scalar_t zoom_reference;
+#endif
+#ifdef CONFIG_IQS5XX_ZOOM_CTRL_WHEEL
+    // Zoom modifier requested from the keystroke player
+    bool zoom_modifier_held;
+    // Wheel units held back until the player has pressed the modifier
+    int32_t zoom_wheel_pending;
+#endif
+    int stable_readings;
+
+    // Scroll state (half pixels in fixed point)
+    tf_scalar_t scroll_accumulator_x;
+    tf_scalar_t scroll_accumulator_y;
+    int64_t last_scroll_time;
+
+#ifdef CONFIG_IQS5XX_SCROLL_HIRES
+    // Scroll movement not yet reported, in 1/multiplier of scroll_accumulator units
+    tf_scalar_t scroll_hires_accum;
+#endif
+#ifdef CONFIG_IQS5XX_SCROLL_COAST
+    // Smoothed scroll speed, hi-res wheel units per ms in Q8
+    int32_t scroll_velocity;
+#endif
+
+    // Movement tracking for gesture detection
+    tf_scalar_t total_movement_x[2];  // Total X movement for each finger
+    tf_scalar_t total_movement_y[2];  // Total Y movement for each finger
+};
+
+#ifdef CONFIG_IQS5XX_SCROLL_COAST
+// Inertial scroll after finger lift (two_finger.c), stepped by a gesture_timer between frames
+struct scroll_coast {
+    struct gesture_timer timer;
+    const struct device *dev;
+    uint16_t code;
+    // Hi-res wheel units per ms in Q8, 0 when idle
+    int32_t velocity;
+    // Sub-unit movement carried between steps, Q8
+    int32_t residual;
+};
+#endif
+
+#ifdef CONFIG_IQS5XX_GESTURE_SWIPE
+// Three to five finger swipe session (swipe.c)
+struct swipe_session {
+    bool active;
+    // Action sent, nothing more until fewer than three fingers remain
+    bool spent;
+    // Centroid left the tap slop, no middle click on lift
+    bool moved;
+    uint8_t fingers;
+    uint8_t max_fingers;
+    // Tracked contacts the start centroid belongs to
+    uint8_t contact_ids[IQS5XX_MAX_FINGERS];
+    int32_t start_x;
+    int32_t start_y;
+    int64_t start_time;
+};
+#endif
+
+// Gesture counters (gesture_recognizer.c)
+struct gesture_stats {
+    // Frames carrying each GestureEvents0 bit: single tap, press and hold, swipe -x, +x, +y, -y
+    uint32_t gestures0[6];
+    // Frames carrying each GestureEvents1 bit: two finger tap, scroll, zoom
+    uint32_t gestures1[3];
+    // Sessions started by the recognizer owning each finger count (drags for one finger)
+    uint32_t sessions[IQS5XX_MAX_FINGERS + 1];
+};
+
+// Common gesture state and configuration, one per trackpad
 struct gesture_state {
     // Accumulated position for movement
+#ifdef CONFIG_IQS5XX_FIXED_POINT
+    // Q7 fixed point (1/128 px)
+    struct {
+        int32_t x;
+        int32_t y;
+    } accumPos;
+#else
     struct {
         float x;
         float y;
     } accumPos;
+#endif
 
     // Single finger / drag state
     bool isDragging;
     bool dragStartSent;
 
+#ifdef CONFIG_IQS5XX_GESTURE_TWO_FINGER
     // Two finger state
     bool twoFingerActive;
     int16_t lastXScrollReport;
@@ -26,7 +146,13 @@ struct gesture_state {
         uint16_t x;
         uint16_t y;
     } twoFingerStartPos[2];
+    struct two_finger_session twoFinger;
+#ifdef CONFIG_IQS5XX_SCROLL_COAST
+    struct scroll_coast scrollCoast;
+#endif
+#endif
 
+#ifdef CONFIG_IQS5XX_GESTURE_THREE_FINGER
     // Three finger state
     bool threeFingersPressed;
     int64_t threeFingerPressTime;
@@ -35,10 +161,25 @@ struct gesture_state {
         int16_t y;
     } threeFingerStartPos[3];
     bool gestureTriggered;
+    // Tracked contacts the start positions belong to
+    uint8_t threeFingerIds[3];
+    // Blocks re-triggering of three finger gestures
+    int64_t threeFingerCooldown;
+#endif
+
+#ifdef CONFIG_IQS5XX_GESTURE_SWIPE
+    struct swipe_session swipe;
+#endif
 
     // General state
+    // Contacts with stable IDs, handlers get the records in tracker slot order
+    struct contact_tracker contacts;
     uint8_t lastFingerCount;
-    uint8_t mouseSensitivity;
+
+    // Profile of the frame being dispatched, gain LUT, thresholds and recognizer table
+    const struct trackpad_profile *profile;
+
+    struct gesture_stats stats;
 };
 
 // Configuration constants
@@ -46,6 +187,8 @@ struct gesture_state {
 #define TRACKPAD_THREE_FINGER_SWIPE_MIN_DIST 30
 #define SCROLL_REPORT_DISTANCE              15
 #define MOVEMENT_THRESHOLD                  0.3f  // Reduced for faster response
+// MOVEMENT_THRESHOLD in Q7, rounded up as accumulated motion is a whole multiple of 1/128
+#define MOVEMENT_THRESHOLD_Q7               ((int32_t)(MOVEMENT_THRESHOLD * GESTURE_SENS_ONE + 0.999f))
 #define ZOOM_THRESHOLD                      80
 #define ZOOM_SENSITIVITY                    40
 
@@ -53,19 +196,12 @@ struct gesture_state {
 
 // single_finger.c
 void handle_single_finger_gestures(const struct device *dev, const struct iqs5xx_rawdata *data, struct gesture_state *state);
-void reset_single_finger_state(struct gesture_state *state);
+void reset_single_finger_state(const struct device *dev, struct gesture_state *state);
 
 // two_finger.c
 void handle_two_finger_gestures(const struct device *dev, const struct iqs5xx_rawdata *data, struct gesture_state *state);
-void reset_two_finger_state(struct gesture_state *state);
+void reset_two_finger_state(const struct device *dev, struct gesture_state *state);
 
 // three_finger.c
 void handle_three_finger_gestures(const struct device *dev, const struct iqs5xx_rawdata *data, struct gesture_state *state);
-void reset_three_finger_state(struct gesture_state *state);
-
-// Input event helper (defined in trackpad.c) - for mouse events
-void send_input_event(uint8_t type, uint16_t code, int32_t value, bool sync);
-
-// Keyboard event helpers using input events (defined in trackpad.c)
-void send_keyboard_key(uint16_t keycode);
-void send_keyboard_combo(uint16_t modifier, uint16_t keycode);
+void reset_three_finger_state(const struct device *dev, struct gesture_state *state);
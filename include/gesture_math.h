@@ -0,0 +1,55 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdlib.h>
+#include "gesture_platform.h"
+
+// Integer helpers for the motion and gesture pipeline (CONFIG_IQS5XX_FIXED_POINT).
+// Deltas are clamped so squared distances and dot products fit in 32 bits.
+
+// Sensitivity is a Q7 multiplier (128 = 1.0), accumulated motion uses the same scale
+#define GESTURE_SENS_SHIFT          7
+#define GESTURE_SENS_ONE            (1 << GESTURE_SENS_SHIFT)
+
+// Largest delta used in products, keeps 2 * d^2 below INT32_MAX
+#define GESTURE_MAX_DELTA           32767
+
+static inline int32_t gesture_clamp_delta(int32_t d) {
+    return CLAMP(d, -GESTURE_MAX_DELTA, GESTURE_MAX_DELTA);
+}
+
+// Squared length of a delta vector
+static inline uint32_t gesture_distance_sq(int32_t dx, int32_t dy) {
+    dx = gesture_clamp_delta(dx);
+    dy = gesture_clamp_delta(dy);
+    return (uint32_t)(dx * dx) + (uint32_t)(dy * dy);
+}
+
+// Dot product of two delta vectors
+static inline int32_t gesture_dot(int32_t dx0, int32_t dy0, int32_t dx1, int32_t dy1) {
+    return gesture_clamp_delta(dx0) * gesture_clamp_delta(dx1) +
+           gesture_clamp_delta(dy0) * gesture_clamp_delta(dy1);
+}
+
+// Integer square root, rounded to nearest
+static inline uint32_t gesture_isqrt(uint32_t n) {
+    uint32_t root = 0;
+    uint32_t bit = 1UL << 30;
+
+    while (bit > n) {
+        bit >>= 2;
+    }
+
+    while (bit != 0) {
+        if (n >= root + bit) {
+            n -= root + bit;
+            root = (root >> 1) + bit;
+        } else {
+            root >>= 1;
+        }
+        bit >>= 2;
+    }
+
+    // n now holds the remainder, round up past the midpoint
+    return (n > root) ? root + 1 : root;
+}
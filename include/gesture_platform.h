@@ -0,0 +1,72 @@
+#pragma once
+
+#include "trackpad_keyboard_events.h"
+
+#ifdef GESTURE_PLATFORM_HEADER
+#include GESTURE_PLATFORM_HEADER
+#else
+
+#include <zephyr/device.h>
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/dt-bindings/input/input-event-codes.h>
+#include <dt-bindings/zmk/keys.h>
+
+// Platform services used by the gesture pipeline (motion_coalescer.c,
+// contact_tracker.c, gesture_recognizer.c and the handlers in single_finger.c,
+// two_finger.c, three_finger.c and swipe.c). These sources and their headers
+// include no Zephyr or ZMK header themselves, everything below comes in through
+// this one, and the frames they process are the plain types of iqs5xx_frame.h.
+//
+// A replay build (tests/gesture_replay) defines GESTURE_PLATFORM_HEADER to a
+// header of its own that provides struct device, the sys/util.h and toolchain
+// macros (MIN, MAX, CLAMP, BIT, ARRAY_SIZE, CONTAINER_OF, BUILD_ASSERT), the
+// INPUT_* event codes, the ZMK key codes and everything declared below. The
+// keystroke sequence types of trackpad_keyboard_events.h are shared, the replay
+// build defines send_trackpad_zoom_*() and gesture_play_keys() to record them.
+
+// Milliseconds since boot
+static inline int64_t gesture_uptime_get(void) {
+    return k_uptime_get();
+}
+
+// Queues a keystroke sequence for playback through the HID layer
+static inline int gesture_play_keys(const struct trackpad_action_seq *seq) {
+    return trackpad_action_enqueue(seq);
+}
+
+// Input event helper (defined in trackpad.c) - for mouse events
+void send_input_event(const struct device *dev, uint8_t type, uint16_t code, int32_t value, bool sync);
+
+struct gesture_timer;
+typedef void (*gesture_timer_handler_t)(struct gesture_timer *timer);
+
+// One shot timer for handler steps that run without a frame. Fires on the system
+// workqueue, the queue gesture dispatch runs on, so it shares gesture state without locks
+struct gesture_timer {
+    struct k_work_delayable work;
+    gesture_timer_handler_t handler;
+};
+
+static inline void gesture_timer_expired(struct k_work *work) {
+    struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+    struct gesture_timer *timer = CONTAINER_OF(dwork, struct gesture_timer, work);
+
+    timer->handler(timer);
+}
+
+static inline void gesture_timer_init(struct gesture_timer *timer, gesture_timer_handler_t handler) {
+    timer->handler = handler;
+    k_work_init_delayable(&timer->work, gesture_timer_expired);
+}
+
+// Fires the timer after delay_ms, replacing an expiry still pending
+static inline void gesture_timer_start(struct gesture_timer *timer, uint32_t delay_ms) {
+    k_work_reschedule(&timer->work, K_MSEC(delay_ms));
+}
+
+static inline void gesture_timer_stop(struct gesture_timer *timer) {
+    k_work_cancel_delayable(&timer->work);
+}
+
+#endif // GESTURE_PLATFORM_HEADER
@@ -0,0 +1,77 @@
+#pragma once
+
+#include "gesture_handlers.h"
+
+// Gesture dispatch table. Each recognizer (single_finger.c, two_finger.c,
+// three_finger.c) exports a descriptor, and gesture_recognizer.c places it in
+// a table indexed by finger count. A frame then costs one lookup: hardware
+// gesture events go to the recognizers that take them, the recognizer owning
+// the current finger count gets the frame, and any other recognizer still
+// holding a session is reset. Recognizers disabled in Kconfig are left out of
+// the table, so their code and state compile out. Each trackpad profile holds
+// its own copy of the finger count table, without the counts it disables.
+
+// Hardware gesture event registers a recognizer takes
+#define GESTURE_RECOGNIZER_EV_GESTURES0     BIT(0)
+#define GESTURE_RECOGNIZER_EV_GESTURES1     BIT(1)
+
+// Highest finger count with a table slot, larger counts reset all recognizers
+#define GESTURE_RECOGNIZER_MAX_FINGERS      5
+
+struct gesture_recognizer {
+    // Handles a frame, for owned frames and hardware gesture events
+    void (*handle)(const struct device *dev, const struct iqs5xx_rawdata *data, struct gesture_state *state);
+    // Ends the session, emitting any pending release or fallback tap
+    void (*reset)(const struct device *dev, struct gesture_state *state);
+    // Optional, ends the session without lift actions (taps, clicks) when the
+    // contacts were rejected as a palm, reset() is used if not set
+    void (*cancel)(const struct device *dev, struct gesture_state *state);
+    // Optional, sets up per trackpad resources once at boot
+    void (*init)(const struct device *dev, struct gesture_state *state);
+    // Optional, called for every frame with fingers down before dispatch
+    void (*touch)(const struct device *dev, struct gesture_state *state);
+    // True while the recognizer holds a session that must be reset on a finger count change
+    bool (*active)(const struct gesture_state *state);
+    // GESTURE_RECOGNIZER_EV_* mask of hardware gesture events routed to handle()
+    uint8_t events;
+    // Hardware gesture events are only taken while no other recognizer is active
+    bool events_exclusive;
+    // Owned frames are handled even when they carry hardware gesture events
+    bool owns_event_frames;
+};
+
+// Per recognizer descriptors, one per enabled CONFIG_IQS5XX_GESTURE_*
+extern const struct gesture_recognizer single_finger_recognizer;
+extern const struct gesture_recognizer two_finger_recognizer;
+extern const struct gesture_recognizer three_finger_recognizer;
+extern const struct gesture_recognizer swipe_recognizer;
+
+/**
+ * @brief Returns the recognizer owning frames with the given finger count, or NULL
+ */
+const struct gesture_recognizer *gesture_recognizer_for(uint8_t finger_count);
+
+/**
+ * @brief Fills a profile's recognizer table, leaving finger counts outside the mask unowned
+ *
+ * @param owners GESTURE_RECOGNIZER_MAX_FINGERS + 1 entries
+ * @param finger_mask Bit n enables the recognizer for n fingers
+ */
+void gesture_recognizer_build_owners(const struct gesture_recognizer **owners, uint8_t finger_mask);
+
+/**
+ * @brief Runs the init hooks of all recognizers for a trackpad
+ */
+void gesture_recognizer_init(const struct device *dev, struct gesture_state *state);
+
+/**
+ * @brief Ends all open sessions without lift actions, as if the contacts had
+ * been rejected, and marks the trackpad as released
+ */
+void gesture_recognizer_cancel(const struct device *dev, struct gesture_state *state);
+
+/**
+ * @brief Runs one dispatch step for a frame and updates state->lastFingerCount
+ */
+void gesture_recognizer_step(const struct device *dev, const struct iqs5xx_rawdata *data,
+                             struct gesture_state *state);
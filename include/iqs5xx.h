@@ -15,90 +15,94 @@
 #include <zephyr/sys/util.h>
 #include <zephyr/drivers/gpio.h>
 #include <zephyr/kernel.h>
+#include "iqs5xx_frame.h"
+#include "iqs5xx_latency.h"
 
-// Single finger data
-struct iqs5xx_finger {
-    // Absolute X position
-    uint16_t ax;
-    // Absolute Y position
-    uint16_t ay;
-    // Touch strength
-    uint16_t strength;
-    // Touch area
-    uint16_t area;
-};
-
-// Data read from the device
-struct iqs5xx_rawdata {
-    // Gesture events 0: Single tap, press and hold, swipe -x, swipe +x, swipe -y, swipe +y
-    uint8_t gestures0;
-    // Gesture events 1: 2 finger tap, scroll, zoom
-    uint8_t gestures1;
-    // System info 0
-    uint8_t system_info0;
-    // System info 1
-    uint8_t system_info1;
-    // Number of fingers
-    uint8_t finger_count;
-    // Relative X position
-    int16_t rx;
-    // Relative Y position
-    int16_t ry;
-    // Fingers
-    struct iqs5xx_finger fingers[5];
-};
+// Register dumping
 
-// Callback
-typedef void (*iqs5xx_trigger_handler_t)(const struct device *dev, const struct iqs5xx_rawdata *data);
+// Start dump from 04D5
+#define IQS5XX_REG_DUMP_START_ADDRESS   0x04D5
+// Write 504 bytes
+#define IQS5XX_REG_DUMP_SIZE            504
+// Dump data
+extern const unsigned char _iqs5xx_regdump[IQS5XX_REG_DUMP_SIZE];
 
-struct iqs5xx_data {
-    // I2C device
-	const struct device *i2c;
-    const struct device *dev;
-    // Data ready callback
-	struct gpio_callback dr_cb;
-    // Data ready callback
-    iqs5xx_trigger_handler_t data_ready_handler;
-    // Device data
-    struct iqs5xx_rawdata raw_data;
-    // i2c mutex
-    struct k_mutex i2c_mutex;
-    // Work queue item for handling interrupts
-    struct k_work work;
-    // Error tracking
-    int consecutive_errors;
-    int64_t last_error_time;
+// Slot of the frame ring between the fetch and dispatch stages
+struct iqs5xx_frame {
+    struct iqs5xx_rawdata raw;
+#ifdef CONFIG_IQS5XX_LATENCY_STATS
+    struct iqs5xx_latency_frame lat;
+#endif
 };
 
-struct iqs5xx_config {
-    // Data ready GPIO spec from devicetree
-    const struct gpio_dt_spec dr;
-    // NEW: Coordinate transformation flags
-    bool invert_x;
-    bool invert_y;
-    bool rotate_90;
-    bool rotate_180;
-    bool rotate_270;
-
-    // Add sensitivity from devicetree
-    uint8_t sensitivity;
+// Error and recovery counters, see iqs5xx_get_error_stats()
+struct iqs5xx_error_stats {
+    // Failed frame reads
+    uint32_t i2c_errors;
+    // Recoveries started after CONFIG_IQS5XX_RECOVERY_ERROR_THRESHOLD failed reads in a row
+    uint32_t recoveries;
+    // Bring-up attempts that failed and were retried after a backoff
+    uint32_t failed_attempts;
+    // Pulses of the reset pin
+    uint32_t hard_resets;
 };
 
-struct coord_transform {
-    int16_t x;
-    int16_t y;
+// Frame and bus counters, see iqs5xx_get_stats()
+struct iqs5xx_stats {
+    // Frames queued for dispatch
+    uint32_t frames;
+    // Frames dropped after the header read, nothing changed
+    uint32_t unchanged;
+    // Frames dropped because the frame ring was full
+    uint32_t frame_overruns;
+    // Frame headers flagging RR_MISSED
+    uint32_t rr_missed;
+    // Frame headers flagging ATI_ERROR or ALP_ATI_ERROR
+    uint32_t ati_errors;
+    // Frame headers flagging REATI_OCCURRED or ALP_REATI_OCCURRED
+    uint32_t reati_events;
+    // Frames dropped or masked by the palm filter, 0 without CONFIG_IQS5XX_PALM_FILTER
+    uint32_t palm_frames;
+    // Frames read again in the next window, 0 without CONFIG_IQS5XX_I2C_ASYNC
+    uint32_t async_rereads;
+    // Mean time a frame read takes, from the address write to END_WINDOW (us)
+    uint32_t bus_time_avg_us;
+    struct iqs5xx_error_stats errors;
 };
 
-struct coord_transform apply_coordinate_transform(int16_t x, int16_t y, const struct iqs5xx_config *config);
-void apply_finger_transform(struct iqs5xx_finger *finger, const struct iqs5xx_config *config);
+// Bring-up (init and recovery) state machine, run from recovery_work
+enum iqs5xx_recovery_state {
+    // Chip configured, the data ready trigger is running
+    IQS5XX_RECOVERY_IDLE,
+    // Assert the reset pin, or reset through SystemControl1 without one
+    IQS5XX_RECOVERY_RESET,
+    // Release the reset pin
+    IQS5XX_RECOVERY_RELEASE,
+    // Wait for the first communication window after the reset
+    IQS5XX_RECOVERY_WAIT_READY,
+    // Write the register configuration and restart the trigger
+    IQS5XX_RECOVERY_CONFIGURE,
+};
 
+// Callback
+typedef void (*iqs5xx_trigger_handler_t)(const struct device *dev, const struct iqs5xx_rawdata *data);
 
 // Register configuration structure
 struct __attribute__((packed)) iqs5xx_reg_config {
     // Refresh rate when the device is active (ms interval)
     uint16_t    activeRefreshRate;
+    // Refresh rate when a finger rests without moving (ms interval)
+    uint16_t    idleTouchRefreshRate;
     // Refresh rate when the device is idling (ms interval)
     uint16_t    idleRefreshRate;
+    // Refresh rates of the low power modes (ms interval)
+    uint16_t    lp1RefreshRate;
+    uint16_t    lp2RefreshRate;
+    // Time before dropping to the next power mode: active, idle touch and idle in s, LP1 in 20 s steps
+    uint8_t     activeTimeout;
+    uint8_t     idleTouchTimeout;
+    uint8_t     idleTimeout;
+    uint8_t     lp1Timeout;
     // Which single finger gestures will be enabled
     uint8_t     singleFingerGestureMask;
     // Which multi finger gestures will be enabled
@@ -113,18 +117,150 @@ struct __attribute__((packed)) iqs5xx_reg_config {
     uint8_t     debounce;
     // i2c timeout in ms
     uint8_t     i2cTimeout;
+    // Event mode and RDY event sources (SystemConfig1)
+    uint8_t     systemConfig1;
     // Filter settings
     uint8_t     filterSettings;
     uint8_t     filterDynBottomBeta;
     uint8_t     filterDynLowerSpeed;
     uint16_t    filterDynUpperSpeed;
+    // Noise reduction and Rx float settings (HardwareSettingsA)
+    uint8_t     hardwareSettingsA;
+    // Palm rejection and axis orientation (XYConfig0)
+    uint8_t     xyConfig0;
+    // Number of contacts the chip reports (MaxMultitouches)
+    uint8_t     maxMultitouches;
+    // Chip palm detection area (channels) and hold time (PalmRejectThreshold/Timeout)
+    uint8_t     palmRejectThreshold;
+    uint8_t     palmRejectTimeout;
 
     // Initial scroll distance (px)
     uint16_t    initScrollDistance;
 };
 
-// Returns the default register configuration
-struct iqs5xx_reg_config iqs5xx_reg_config_default ();
+struct iqs5xx_data {
+    const struct device *dev;
+    // Data ready callback
+	struct gpio_callback dr_cb;
+    // Data ready callback
+    iqs5xx_trigger_handler_t data_ready_handler;
+    // Frame ring, written by the fetch work item and read by the dispatch work item.
+    // Indices are free running, the slot is the index modulo the ring size.
+    struct iqs5xx_frame frames[CONFIG_IQS5XX_FRAME_RING_SIZE];
+    atomic_t frame_head;
+    atomic_t frame_tail;
+    // Frames dropped because the ring was full
+    uint32_t frame_overruns;
+    // Landing slot for frames read while the ring is full
+    struct iqs5xx_frame overrun_frame;
+    // Finger count of the last fetched frame, sizes the next read
+    uint8_t last_finger_count;
+    // Frames the chip reported as having missed their refresh slot (RR_MISSED)
+    uint32_t rr_missed;
+    // Frames queued for dispatch, and frames dropped after the header read
+    uint32_t frames_fetched;
+    uint32_t frames_unchanged;
+    // Frames flagging an ATI error or a re-ATI (SystemInfo0)
+    uint32_t ati_errors;
+    uint32_t reati_events;
+    // Cycles spent in frame reads, and the number of reads
+    uint64_t bus_cycles;
+    uint32_t bus_reads;
+#ifdef CONFIG_IQS5XX_PALM_FILTER
+    // Contacts are rejected as a palm until the next full lift
+    bool palm_active;
+    // Finger count of the last frame passed on to the handler
+    uint8_t reported_finger_count;
+    // Frames dropped or masked by the palm filter
+    uint32_t palm_frames;
+#endif
+#ifdef CONFIG_IQS5XX_I2C_ASYNC
+    // Bus lock, a semaphore so the data ready ISR can take it without waiting
+    struct k_sem bus_sem;
+    // IQS5XX_ASYNC_* bits
+    atomic_t async_flags;
+    // Chained frame read and END_WINDOW write of the transfer in flight
+    struct i2c_msg async_msgs[3];
+    uint8_t async_addr[2];
+    uint8_t async_buf[IQS5XX_FRAME_MAX_LEN];
+    uint8_t async_records;
+    // Cycle count at the start of the transfer in flight
+    uint32_t async_start;
+    // Frames read with too few finger records and read again in the next window
+    uint32_t async_rereads;
+#else
+    // i2c mutex
+    struct k_mutex i2c_mutex;
+#endif
+    // Data ready trigger running (interrupt enabled or poll loop scheduled)
+    bool trigger_enabled;
+#ifndef CONFIG_IQS5XX_POLL
+    // Set while a register write waits for a window, the data ready ISR then
+    // gives ready_sem instead of fetching a frame
+    atomic_t ready_wait;
+    struct k_sem ready_sem;
+#endif
+    // Work queue item for handling interrupts
+    struct k_work work;
+    // Work item passing fetched frames to the trigger handler
+    struct k_work process_work;
+#ifdef CONFIG_IQS5XX_TRIGGER_OWN_THREAD
+    // Driver owned workqueue the work item is submitted to
+    K_KERNEL_STACK_MEMBER(thread_stack, CONFIG_IQS5XX_THREAD_STACK_SIZE);
+    struct k_work_q workq;
+#endif
+#ifdef CONFIG_IQS5XX_POLL
+    // Poll loop state
+    struct k_work_delayable poll_work;
+    uint8_t poll_misses;
+    uint8_t poll_idle_frames;
+    // Poll periods, mirrors the programmed refresh rates (ms)
+    uint16_t active_rr;
+    uint16_t idle_rr;
+#endif
+    // Register image (dump plus config) last written to the device
+    uint8_t reg_image[IQS5XX_REG_DUMP_SIZE];
+    bool reg_image_valid;
+    // Config the image was built from, re-applied on resume and by bring-up
+    struct iqs5xx_reg_config reg_config;
+#ifdef CONFIG_IQS5XX_LATENCY_STATS
+    // Per-stage frame timestamps
+    struct iqs5xx_latency latency;
+#endif
+    // Error tracking
+    uint8_t consecutive_errors;
+    struct iqs5xx_error_stats errors;
+    // Bring-up state machine, runs on the same workqueue as the fetch work item
+    struct k_work_delayable recovery_work;
+    enum iqs5xx_recovery_state recovery_state;
+    // Failed bring-up attempts in a row, sizes the backoff
+    uint8_t recovery_attempts;
+    // Uptime (ms) at which IQS5XX_RECOVERY_WAIT_READY gives up
+    int64_t recovery_deadline;
+};
+
+struct iqs5xx_config {
+    // Devicetree instance number
+    uint8_t instance;
+    // I2C bus and address from devicetree
+    struct i2c_dt_spec i2c;
+    // Data ready GPIO spec from devicetree
+    const struct gpio_dt_spec dr;
+    // Optional reset GPIO spec from devicetree, port is NULL without one
+    const struct gpio_dt_spec reset;
+#ifdef CONFIG_IQS5XX_PALM_FILTER
+    // Contacts larger than this area are rejected, 0 disables
+    uint8_t palm_area_max;
+    // Contacts weaker than this strength are rejected
+    uint16_t finger_strength_min;
+#endif
+
+    // Register configuration from devicetree
+    struct iqs5xx_reg_config reg_config;
+};
+
+
+
 
 /**
  * @brief Initializes registers
@@ -135,6 +271,86 @@ struct iqs5xx_reg_config iqs5xx_reg_config_default ();
  */
 int iqs5xx_registers_init (const struct device *dev, const struct iqs5xx_reg_config *config);
 
+/**
+ * @brief Copies the register configuration currently applied
+ *
+ * @param dev
+ * @param config
+ * @return int
+ */
+int iqs5xx_get_config(const struct device *dev, struct iqs5xx_reg_config *config);
+
+/**
+ * @brief Changes the active and idle refresh rates at runtime
+ *
+ * Only the changed registers are written while the device keeps its configuration.
+ *
+ * @param dev
+ * @param active_ms Active refresh rate (ms interval)
+ * @param idle_ms Idle refresh rate (ms interval)
+ * @return int
+ */
+int iqs5xx_set_refresh_rate(const struct device *dev, uint16_t active_ms, uint16_t idle_ms);
+
+/**
+ * @brief Changes the filter settings at runtime
+ *
+ * @param dev
+ * @param settings FilterSettings0 bits (MAV_FILTER, IIR_FILTER, IIR_SELECT, ...)
+ * @param bottom_beta Dynamic filter bottom beta
+ * @param lower_speed Dynamic filter lower speed
+ * @param upper_speed Dynamic filter upper speed
+ * @return int
+ */
+int iqs5xx_set_filter(const struct device *dev, uint8_t settings, uint8_t bottom_beta,
+                      uint8_t lower_speed, uint16_t upper_speed);
+
+/**
+ * @brief Restores the register configuration from devicetree
+ *
+ * @param dev
+ * @return int
+ */
+int iqs5xx_restore_config(const struct device *dev);
+
+/**
+ * @brief Copies the error and recovery counters
+ *
+ * @param dev
+ * @param stats
+ * @return int
+ */
+int iqs5xx_get_error_stats(const struct device *dev, struct iqs5xx_error_stats *stats);
+
+/**
+ * @brief Copies the frame, bus and error counters
+ *
+ * @param dev
+ * @param stats
+ * @return int
+ */
+int iqs5xx_get_stats(const struct device *dev, struct iqs5xx_stats *stats);
+
+/**
+ * @brief Clears the frame, bus and error counters
+ *
+ * @param dev
+ */
+void iqs5xx_reset_stats(const struct device *dev);
+
+/**
+ * @brief Reads chip registers in a communication window of their own
+ *
+ * The read waits for the next window, like any host initiated read.
+ *
+ * @param dev
+ * @param addr First register address
+ * @param buf
+ * @param len
+ * @return int, -EBUSY while the chip is being brought up
+ */
+int iqs5xx_read_registers(const struct device *dev, uint16_t addr, uint8_t *buf, uint8_t len);
+
 int iqs5xx_trigger_set(const struct device *dev, iqs5xx_trigger_handler_t handler);
 
 // Byte swap macros
@@ -152,39 +368,8 @@ int iqs5xx_trigger_set(const struct device *dev, iqs5xx_trigger_handler_t handle
 //*****************************************************************************
 
 //
-//! GestureEvents0 bit definitions
-//
-#define GESTURE_SWIPE_Y_NEG	    		0x20
-#define GESTURE_SWIPE_Y_POS	    		0x10
-#define GESTURE_SWIPE_X_POS      		0x08
-#define GESTURE_SWIPE_X_NEG        		0x04
-#define GESTURE_TAP_AND_HOLD     		0x02
-#define GESTURE_SINGLE_TAP        		0x01
+//! GestureEvents0/1 and SystemInfo0/1 bit definitions are in iqs5xx_frame.h
 //
-//! GesturesEvents1 bit definitions
-//
-#define GESTURE_ZOOM	          		0x04
-#define GESTURE_SCROLLG		     		0x02
-#define GESTURE_TWO_FINGER_TAP       	0x01
-//
-//! SystemInfo0 bit definitions
-//
-#define	SHOW_RESET				0x80
-#define	ALP_REATI_OCCURRED		0x40
-#define	ALP_ATI_ERROR			0x20
-#define	REATI_OCCURRED			0x10
-#define	ATI_ERROR				0x08
-#define	CHARGING_MODE_2			0x04
-#define CHARGING_MODE_1			0x02
-#define	CHARGING_MODE_0			0x01
-//
-//! SystemInfo1 bit definitions
-//
-#define	SNAP_TOGGLE				0x10
-#define	RR_MISSED				0x08
-#define	TOO_MANY_FINGERS		0x04
-#define PALM_DETECT				0x02
-#define	TP_MOVEMENT				0x01
 //
 //! SystemControl0 bit definitions
 //
@@ -399,15 +584,6 @@ int iqs5xx_trigger_set(const struct device *dev, iqs5xx_trigger_handler_t handle
 #define	ZoomInitDistance_adr	0x06CB	//(READ/WRITE/E2)	//2 BYTES;
 #define	ZoomConsDistance_adr	0x06CD	//(READ/WRITE/E2)	//2 BYTES;
 
-
-// Register dumping
-
-// Start dump from 04D5
-#define IQS5XX_REG_DUMP_START_ADDRESS   0x04D5
-// Write 504 bytes
-#define IQS5XX_REG_DUMP_SIZE            504
-// Dump data
-extern const unsigned char _iqs5xx_regdump[IQS5XX_REG_DUMP_SIZE];
 #define ProjectNumber_adr		0x0002	//(READ)			//2 BYTES;
 #define MajorVersion_adr		0x0004	//(READ)
 #define MinorVersion_adr		0x0005	//(READ)
@@ -0,0 +1,41 @@
+#pragma once
+
+#include <zephyr/device.h>
+#include "iqs5xx.h"
+
+// Frame capture stream (CONFIG_IQS5XX_CAPTURE)
+//
+// The stream is a sequence of records, one per fetched frame:
+//
+//   tag         1 byte   bits 0-2 finger count, bit 3 gestures follow,
+//                        bit 4 system info follows, bit 5 keyframe,
+//                        bits 6-7 device instance
+//   dt          varint   microseconds since the previous record of the instance
+//   gestures    2 bytes  gestures0, gestures1 (bit 3)
+//   sysinfo     2 bytes  system_info0, system_info1 (bit 4)
+//   rx, ry      zigzag varints
+//   per finger  ax, ay, strength as zigzag varint deltas to the same slot of
+//               the previous record, area as 1 byte
+//
+// Varints are unsigned LEB128. A keyframe carries deltas against zero and
+// all optional fields, and is sent first and after any dropped record.
+
+#define IQS5XX_CAPTURE_TAG_FINGERS      0x07
+#define IQS5XX_CAPTURE_TAG_GESTURES     BIT(3)
+#define IQS5XX_CAPTURE_TAG_SYSINFO      BIT(4)
+#define IQS5XX_CAPTURE_TAG_KEYFRAME     BIT(5)
+#define IQS5XX_CAPTURE_TAG_INSTANCE_POS 6
+
+#ifdef CONFIG_IQS5XX_CAPTURE
+
+/**
+ * @brief Encodes a fetched frame into the capture ring. Never blocks, frames
+ * that do not fit are dropped and the next one is sent as a keyframe.
+ */
+void iqs5xx_capture_frame(const struct device *dev, const struct iqs5xx_rawdata *frame);
+
+#else
+
+static inline void iqs5xx_capture_frame(const struct device *dev, const struct iqs5xx_rawdata *frame) {}
+
+#endif
@@ -0,0 +1,85 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+
+// Frame data as the driver hands it to the trigger handler. Kept free of
+// Zephyr headers, the gesture pipeline sees the driver only through these types.
+
+// Maximum number of contacts reported by the device
+#define IQS5XX_MAX_FINGERS  5
+
+// Frame layout starting at GestureEvents0_adr
+#define IQS5XX_FRAME_HEADER_LEN     9
+#define IQS5XX_FINGER_RECORD_LEN    7
+#define IQS5XX_FRAME_MAX_LEN        (IQS5XX_FRAME_HEADER_LEN + IQS5XX_FINGER_RECORD_LEN * IQS5XX_MAX_FINGERS)
+
+// Single finger data
+struct iqs5xx_finger {
+    // Absolute X position
+    uint16_t ax;
+    // Absolute Y position
+    uint16_t ay;
+    // Touch strength
+    uint16_t strength;
+    // Touch area
+    uint16_t area;
+};
+
+// Data read from the device
+struct iqs5xx_rawdata {
+    // Gesture events 0: Single tap, press and hold, swipe -x, swipe +x, swipe -y, swipe +y
+    uint8_t gestures0;
+    // Gesture events 1: 2 finger tap, scroll, zoom
+    uint8_t gestures1;
+    // System info 0
+    uint8_t system_info0;
+    // System info 1
+    uint8_t system_info1;
+    // Number of fingers
+    uint8_t finger_count;
+    // Relative X position
+    int16_t rx;
+    // Relative Y position
+    int16_t ry;
+    // The palm filter dropped the contact rx and ry belong to, gesture
+    // processing takes the motion of the first kept contact instead
+    bool rel_from_contacts;
+    // Fingers
+    struct iqs5xx_finger fingers[IQS5XX_MAX_FINGERS];
+};
+
+//
+//! GestureEvents0 bit definitions
+//
+#define GESTURE_SWIPE_Y_NEG	    		0x20
+#define GESTURE_SWIPE_Y_POS	    		0x10
+#define GESTURE_SWIPE_X_POS      		0x08
+#define GESTURE_SWIPE_X_NEG        		0x04
+#define GESTURE_TAP_AND_HOLD     		0x02
+#define GESTURE_SINGLE_TAP        		0x01
+//
+//! GesturesEvents1 bit definitions
+//
+#define GESTURE_ZOOM	          		0x04
+#define GESTURE_SCROLLG		     		0x02
+#define GESTURE_TWO_FINGER_TAP       	0x01
+//
+//! SystemInfo0 bit definitions
+//
+#define	SHOW_RESET				0x80
+#define	ALP_REATI_OCCURRED		0x40
+#define	ALP_ATI_ERROR			0x20
+#define	REATI_OCCURRED			0x10
+#define	ATI_ERROR				0x08
+#define	CHARGING_MODE_2			0x04
+#define CHARGING_MODE_1			0x02
+#define	CHARGING_MODE_0			0x01
+//
+//! SystemInfo1 bit definitions
+//
+#define	SNAP_TOGGLE				0x10
+#define	RR_MISSED				0x08
+#define	TOO_MANY_FINGERS		0x04
+#define PALM_DETECT				0x02
+#define	TP_MOVEMENT				0x01
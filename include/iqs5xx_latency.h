@@ -0,0 +1,91 @@
+#pragma once
+
+#include <zephyr/kernel.h>
+#include <zephyr/device.h>
+
+// Pipeline stages, timestamped per frame
+enum iqs5xx_latency_stage {
+    // Data ready interrupt (absent in poll mode)
+    IQS5XX_LAT_ISR,
+    // Fetch work item started
+    IQS5XX_LAT_WORK_START,
+    // I2C transaction finished
+    IQS5XX_LAT_I2C_DONE,
+    // Frame parsed and transformed
+    IQS5XX_LAT_PARSE_DONE,
+    // First input report of the frame submitted
+    IQS5XX_LAT_REPORT,
+    // Gesture handlers returned
+    IQS5XX_LAT_DISPATCH_DONE,
+    IQS5XX_LAT_STAGE_COUNT,
+};
+
+// Latency of a stage relative to the start of the frame
+struct iqs5xx_latency_stats {
+    uint32_t count;
+    uint32_t min_us;
+    uint32_t avg_us;
+    uint32_t p99_us;
+    uint32_t max_us;
+};
+
+#ifdef CONFIG_IQS5XX_LATENCY_STATS
+
+// Stage timestamps of one frame, travels with the frame through the frame ring
+struct iqs5xx_latency_frame {
+    uint32_t cycles[IQS5XX_LAT_STAGE_COUNT];
+    uint32_t marks;
+};
+
+// Per-device latency recorder, embedded in the driver data
+struct iqs5xx_latency {
+    // Interrupt timestamp of the next frame, the ISR may fire while a frame is processed
+    volatile uint32_t isr_cycles;
+    volatile bool isr_pending;
+    // Frame being fetched, and frame being dispatched to the gesture handlers
+    struct iqs5xx_latency_frame fetch;
+    struct iqs5xx_latency_frame dispatch;
+    // Stage latencies in cycles since the start of the frame
+    uint32_t ring[CONFIG_IQS5XX_LATENCY_RING_SIZE][IQS5XX_LAT_STAGE_COUNT];
+    uint32_t ring_head;
+    uint32_t ring_count;
+    struct k_spinlock ring_lock;
+};
+
+/**
+ * @brief Timestamps a stage of the current frame. Safe to call from an ISR.
+ */
+void iqs5xx_latency_mark(const struct device *dev, enum iqs5xx_latency_stage stage);
+
+/**
+ * @brief Stores the timestamps of the fetched frame with the frame
+ */
+void iqs5xx_latency_publish(const struct device *dev, struct iqs5xx_latency_frame *frame);
+
+/**
+ * @brief Starts dispatching a frame fetched earlier
+ */
+void iqs5xx_latency_consume(const struct device *dev, const struct iqs5xx_latency_frame *frame);
+
+/**
+ * @brief Ends the dispatched frame and stores its timestamps in the ring buffer
+ */
+void iqs5xx_latency_frame_end(const struct device *dev);
+
+/**
+ * @brief Computes per-stage statistics over the frames in the ring buffer
+ *
+ * @param dev
+ * @param stats One entry per stage
+ */
+void iqs5xx_latency_get(const struct device *dev, struct iqs5xx_latency_stats stats[IQS5XX_LAT_STAGE_COUNT]);
+
+// Clears the ring buffer
+void iqs5xx_latency_reset(const struct device *dev);
+
+#else
+
+static inline void iqs5xx_latency_mark(const struct device *dev, enum iqs5xx_latency_stage stage) {}
+static inline void iqs5xx_latency_frame_end(const struct device *dev) {}
+
+#endif
@@ -0,0 +1,49 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "iqs5xx_frame.h"
+
+// Report rate limiter. Plain motion frames arriving within the report interval
+// of the last frame let through are held back and their motion summed, the
+// next frame let through carries it. Frames with hardware gesture events or a
+// finger count change always go through, and a finger count change after one
+// finger flushes the held back motion as a last frame of the old finger set.
+
+// Most frames a single fed frame can turn into
+#define MOTION_COALESCER_MAX_OUT    2
+
+struct motion_coalescer {
+    // Time of the last motion frame let through (ms)
+    int64_t last_report;
+    // Motion of the frames held back since
+    int32_t pending_rx;
+    int32_t pending_ry;
+    // Last frame held back, the finger set change flush replays it
+    struct iqs5xx_rawdata held;
+    // Frame handed out with the pending motion added
+    struct iqs5xx_rawdata merged;
+};
+
+/**
+ * @brief Rate limits a frame
+ *
+ * @param mc
+ * @param frame Frame as parsed
+ * @param last_finger_count Finger count of the last frame dispatched
+ * @param now Frame time (ms)
+ * @param interval Minimum interval between motion frames (ms)
+ * @param out Frames to dispatch in order, pointing to frame or into mc until the next call
+ * @return Number of frames in out, 0 when the frame was held back
+ */
+uint8_t motion_coalescer_feed(struct motion_coalescer *mc, const struct iqs5xx_rawdata *frame,
+                              uint8_t last_finger_count, int64_t now, uint16_t interval,
+                              const struct iqs5xx_rawdata *out[MOTION_COALESCER_MAX_OUT]);
+
+/**
+ * @brief Drops the held back motion
+ */
+static inline void motion_coalescer_reset(struct motion_coalescer *mc) {
+    mc->pending_rx = 0;
+    mc->pending_ry = 0;
+}
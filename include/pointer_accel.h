@@ -0,0 +1,43 @@
+#pragma once
+
+#include <stdint.h>
+#include <stdlib.h>
+#include "gesture_platform.h"
+
+// Pointer acceleration curve types, in devicetree enum order
+enum pointer_accel_curve {
+    POINTER_ACCEL_NONE = 0,
+    POINTER_ACCEL_LINEAR,
+    POINTER_ACCEL_QUADRATIC,
+    POINTER_ACCEL_SMOOTHSTEP,
+};
+
+// Acceleration profile, gains are Q7 (128 = 1.0)
+struct pointer_accel_params {
+    uint8_t curve;
+    // Speed (counts per report) where the gain starts rising
+    uint8_t knee_low;
+    // Speed where the gain reaches max_gain
+    uint8_t knee_high;
+    uint16_t min_gain;
+    uint16_t max_gain;
+};
+
+// Number of LUT entries, speeds at or above the last entry share it
+#define POINTER_ACCEL_LUT_SIZE  32
+
+/**
+ * @brief Fills the gain table with sensitivity * curve(speed), in Q7
+ *
+ * @param lut
+ * @param params
+ * @param sensitivity Q7 base sensitivity
+ */
+void pointer_accel_build_lut(uint16_t lut[POINTER_ACCEL_LUT_SIZE], const struct pointer_accel_params *params,
+                             uint8_t sensitivity);
+
+// LUT index for a motion delta, its largest axis magnitude
+static inline uint8_t pointer_accel_index(int16_t rx, int16_t ry) {
+    int32_t speed = MAX(abs(rx), abs(ry));
+    return (uint8_t)MIN(speed, POINTER_ACCEL_LUT_SIZE - 1);
+}
@@ -1,13 +1,99 @@
 // include/trackpad_keyboard_events.h - Updated for ZMK
 #pragma once
 
-#include <zephyr/device.h>
+#include <stdint.h>
+#include <stdbool.h>
+
+// Includes no Zephyr header so the gesture handlers can use it in a replay
+// build (see gesture_platform.h), TRACKPAD_ACTION_SEQ_DEFINE needs ARRAY_SIZE
+struct device;
+
+// Keystroke sequence step operations
+enum trackpad_action_op {
+    // Press a key and send a report
+    TRACKPAD_ACTION_PRESS,
+    // Release a key and send a report
+    TRACKPAD_ACTION_RELEASE,
+    // Clear the keyboard report and send it
+    TRACKPAD_ACTION_CLEAR,
+    // Do nothing, only wait
+    TRACKPAD_ACTION_WAIT,
+};
+
+// Single step of a keystroke sequence
+struct trackpad_action_step {
+    uint8_t op;
+    // Key usage for press/release steps
+    uint32_t keycode;
+    // Time to wait before the next step is played
+    uint16_t delay_ms;
+};
+
+// Keystroke sequence descriptor, queued by gesture handlers
+struct trackpad_action_seq {
+    const struct trackpad_action_step *steps;
+    uint8_t len;
+};
+
+// Step constructors
+#define TRACKPAD_ACTION_PRESS(key, delay)   { .op = TRACKPAD_ACTION_PRESS, .keycode = (key), .delay_ms = (delay) }
+#define TRACKPAD_ACTION_RELEASE(key, delay) { .op = TRACKPAD_ACTION_RELEASE, .keycode = (key), .delay_ms = (delay) }
+#define TRACKPAD_ACTION_CLEAR(delay)        { .op = TRACKPAD_ACTION_CLEAR, .delay_ms = (delay) }
+#define TRACKPAD_ACTION_WAIT(delay)         { .op = TRACKPAD_ACTION_WAIT, .delay_ms = (delay) }
+
+// Modifier + key combo: clear, press modifier, press key, hold, release both, clear
+#define TRACKPAD_ACTION_COMBO(mod, key, hold)   \
+    TRACKPAD_ACTION_CLEAR(50),                  \
+    TRACKPAD_ACTION_PRESS(mod, 30),             \
+    TRACKPAD_ACTION_PRESS(key, hold),           \
+    TRACKPAD_ACTION_RELEASE(key, 20),           \
+    TRACKPAD_ACTION_RELEASE(mod, 30),           \
+    TRACKPAD_ACTION_CLEAR(20)
+
+// Defines a static keystroke sequence from a list of steps
+#define TRACKPAD_ACTION_SEQ_DEFINE(name, ...)                                   \
+    static const struct trackpad_action_step name##_steps[] = { __VA_ARGS__ };  \
+    static const struct trackpad_action_seq name = {                            \
+        .steps = name##_steps,                                                  \
+        .len = ARRAY_SIZE(name##_steps),                                        \
+    }
 
 // Initialize the keyboard events system
 int trackpad_keyboard_init(const struct device *input_dev);
 
+/**
+ * @brief Queues a keystroke sequence for asynchronous playback
+ *
+ * Never blocks. The sequence must stay valid until it has been played.
+ *
+ * @param seq
+ * @return int 0 on success, -ENOMEM if the queue is full
+ */
+int trackpad_action_enqueue(const struct trackpad_action_seq *seq);
+
 // Function declarations for trackpad keyboard events using ZMK's event system
 void send_trackpad_f3(void);
 void send_trackpad_f4(void);
 void send_trackpad_zoom_in(void);
 void send_trackpad_zoom_out(void);
+
+/**
+ * @brief Queues one short zoom in or out shortcut of the configured host profile
+ */
+void send_trackpad_zoom_step(bool zoom_in);
+
+/**
+ * @brief Requests the zoom modifier down or up, for Ctrl + wheel zoom
+ *
+ * The keystroke player applies the request between sequences and queues no
+ * further sequence while the modifier is down, so no shortcut clears it.
+ * Never dropped, unlike queued sequences.
+ */
+void send_trackpad_zoom_hold(bool hold);
+
+/**
+ * @brief Tells whether the player has sent the zoom modifier press
+ *
+ * Wheel events only zoom once it has, handlers hold them back until then.
+ */
+bool trackpad_zoom_held(void);
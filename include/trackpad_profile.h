@@ -0,0 +1,64 @@
+#pragma once
+
+#include "gesture_platform.h"
+#include "pointer_accel.h"
+
+// Pointer and gesture profiles. Profile 0 comes from the trackpad node, more
+// come from its child nodes, each property falling back to the trackpad node.
+// Everything frame handling needs (gain LUT, thresholds, recognizer table) is
+// precomputed at boot, switching profiles swaps a pointer that gesture
+// dispatch picks up once per frame.
+
+struct gesture_recognizer;
+
+// Highest finger count with a recognizer slot, matches GESTURE_RECOGNIZER_MAX_FINGERS
+#define TRACKPAD_PROFILE_MAX_FINGERS    5
+
+struct trackpad_profile {
+    // Sensitivity times acceleration gain (Q7), indexed by pointer_accel_index()
+    uint16_t gain_lut[POINTER_ACCEL_LUT_SIZE];
+    // Recognizer owning each finger count, NULL for counts disabled in this profile
+    const struct gesture_recognizer *owners[TRACKPAD_PROFILE_MAX_FINGERS + 1];
+
+    // Q7 base sensitivity and acceleration curve the LUT is built from
+    uint8_t sensitivity;
+    struct pointer_accel_params accel;
+    // Bit n enables the software recognizer for n fingers
+    uint8_t recognizer_fingers;
+
+    // Minimum interval between movement reports (ms)
+    uint16_t report_interval;
+    // Two finger scroll speed multiplier
+    uint8_t scroll_sensitivity;
+    // Movement before two fingers scroll, spread change before they zoom (px)
+    uint16_t scroll_threshold;
+    uint16_t zoom_threshold;
+    // Weaker contacts don't take part in two finger gestures (trackpad node's finger-strength-min)
+    uint16_t finger_strength_min;
+
+    // Chip settings written on a switch, -1 keeps the value in place. Values a
+    // profile overrides, runtime changes included, are written back when a
+    // profile without the override is selected.
+    int32_t active_rr;
+    int16_t single_finger_gestures;
+    int16_t multi_finger_gestures;
+
+    // ZMK layers selecting the profile, the highest active layer decides
+    uint32_t layers;
+};
+
+/**
+ * @brief Selects a profile, until the next layer change selects one again
+ *
+ * The chip settings of the profile are written from the system workqueue.
+ *
+ * @param dev Trackpad device
+ * @param index 0 for the trackpad node, n for its n-th child profile
+ * @return 0, -ENODEV for an unknown device, -EINVAL for an unknown profile
+ */
+int trackpad_profile_select(const struct device *dev, uint8_t index);
+
+/**
+ * @brief Returns the index of the selected profile, or -ENODEV
+ */
+int trackpad_profile_get(const struct device *dev);
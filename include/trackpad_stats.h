@@ -0,0 +1,33 @@
+#pragma once
+
+#include <zephyr/device.h>
+#include "gesture_handlers.h"
+
+// Frame handling counters of a trackpad, next to the driver's iqs5xx_get_stats()
+
+struct trackpad_stats {
+    // Frames received from the driver
+    uint32_t frames;
+    // Movement frames held back by report-interval-ms, their motion is sent with the next report
+    uint32_t rate_limited;
+    // Frames dropped by the typing guard (CONFIG_IQS5XX_TYPING_GUARD)
+    uint32_t typing_dropped;
+    struct gesture_stats gestures;
+};
+
+/**
+ * @brief Copies the frame handling and gesture counters
+ *
+ * @param dev Trackpad device
+ * @param stats
+ * @return 0, -ENODEV for an unknown device
+ */
+int trackpad_get_stats(const struct device *dev, struct trackpad_stats *stats);
+
+/**
+ * @brief Clears the frame handling and gesture counters
+ *
+ * @param dev Trackpad device
+ * @return 0, -ENODEV for an unknown device
+ */
+int trackpad_reset_stats(const struct device *dev);
@@ -0,0 +1,120 @@
+#include <string.h>
+#include "gesture_platform.h"
+#include "contact_tracker.h"
+#include "gesture_math.h"
+
+#define CONTACT_TRACKER_GATE_SQ ((uint32_t)CONTACT_TRACKER_MAX_JUMP * CONTACT_TRACKER_MAX_JUMP)
+#define CONTACT_NONE            UINT8_MAX
+
+// Smoothed velocity, half of the old estimate and half of the new one
+static int16_t contact_velocity(int16_t old, int32_t delta, int32_t dt_ms) {
+    int32_t v = (delta * 1000) / dt_ms;
+
+    return (int16_t)CLAMP((old + v) / 2, INT16_MIN, INT16_MAX);
+}
+
+void contact_tracker_update(struct contact_tracker *tracker, const struct iqs5xx_rawdata *frame,
+                            int64_t now, struct iqs5xx_rawdata *out) {
+    const uint8_t records = MIN(frame->finger_count, IQS5XX_MAX_FINGERS);
+    const int32_t dt = CLAMP((int32_t)(now - tracker->last_time), 1, 1000);
+    uint32_t cost[IQS5XX_MAX_FINGERS][IQS5XX_MAX_FINGERS];
+    uint8_t slot_of[IQS5XX_MAX_FINGERS];
+    bool matched[IQS5XX_MAX_FINGERS] = {false};
+
+    memset(slot_of, CONTACT_NONE, sizeof(slot_of));
+    tracker->last_time = now;
+
+    // Squared distance of every tracked contact to every record
+    for (uint8_t s = 0; s < IQS5XX_MAX_FINGERS; s++) {
+        for (uint8_t r = 0; r < records; r++) {
+            cost[s][r] = (tracker->slots[s].id == 0) ? UINT32_MAX :
+                         gesture_distance_sq(frame->fingers[r].ax - tracker->slots[s].x,
+                                             frame->fingers[r].ay - tracker->slots[s].y);
+        }
+    }
+
+    // Greedy nearest neighbour, closest pair first
+    for (uint8_t n = 0; n < records; n++) {
+        uint32_t best = CONTACT_TRACKER_GATE_SQ + 1;
+        uint8_t best_s = CONTACT_NONE, best_r = CONTACT_NONE;
+
+        for (uint8_t s = 0; s < IQS5XX_MAX_FINGERS; s++) {
+            if (matched[s]) {
+                continue;
+            }
+            for (uint8_t r = 0; r < records; r++) {
+                if (slot_of[r] == CONTACT_NONE && cost[s][r] < best) {
+                    best = cost[s][r];
+                    best_s = s;
+                    best_r = r;
+                }
+            }
+        }
+
+        if (best_s == CONTACT_NONE) {
+            break;
+        }
+        matched[best_s] = true;
+        slot_of[best_r] = best_s;
+    }
+
+    // Unmatched contacts have lifted
+    for (uint8_t s = 0; s < IQS5XX_MAX_FINGERS; s++) {
+        if (!matched[s]) {
+            tracker->slots[s].id = 0;
+        }
+    }
+
+    for (uint8_t r = 0; r < records; r++) {
+        const struct iqs5xx_finger *finger = &frame->fingers[r];
+        struct tracked_contact *c;
+
+        if (slot_of[r] == CONTACT_NONE) {
+            // New contact, lowest free slot
+            uint8_t s = 0;
+            while (tracker->slots[s].id != 0) {
+                s++;
+            }
+            slot_of[r] = s;
+            c = &tracker->slots[s];
+
+            if (++tracker->next_id == 0) {
+                tracker->next_id = 1;
+            }
+            *c = (struct tracked_contact){ .id = tracker->next_id };
+        } else {
+            c = &tracker->slots[slot_of[r]];
+            c->dx = (int16_t)(finger->ax - c->x);
+            c->dy = (int16_t)(finger->ay - c->y);
+            c->vx = contact_velocity(c->vx, c->dx, dt);
+            c->vy = contact_velocity(c->vy, c->dy, dt);
+        }
+
+        c->x = finger->ax;
+        c->y = finger->ay;
+        c->strength = finger->strength;
+        c->area = finger->area;
+    }
+
+    // Records in slot order
+    *out = *frame;
+    tracker->count = 0;
+    for (uint8_t s = 0; s < IQS5XX_MAX_FINGERS; s++) {
+        if (tracker->slots[s].id == 0) {
+            continue;
+        }
+        for (uint8_t r = 0; r < records; r++) {
+            if (slot_of[r] == s) {
+                out->fingers[tracker->count] = frame->fingers[r];
+            }
+        }
+        tracker->order[tracker->count++] = s;
+    }
+}
+
+void contact_tracker_reset(struct contact_tracker *tracker) {
+    for (uint8_t s = 0; s < IQS5XX_MAX_FINGERS; s++) {
+        tracker->slots[s].id = 0;
+    }
+    tracker->count = 0;
+}
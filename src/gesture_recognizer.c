@@ -0,0 +1,173 @@
+#include "gesture_recognizer.h"
+
+// Recognizer owning each finger count, NULL slots reset everything
+static const struct gesture_recognizer *const recognizer_by_fingers[GESTURE_RECOGNIZER_MAX_FINGERS + 1] = {
+#ifdef CONFIG_IQS5XX_GESTURE_SINGLE_FINGER
+    [1] = &single_finger_recognizer,
+#endif
+#ifdef CONFIG_IQS5XX_GESTURE_TWO_FINGER
+    [2] = &two_finger_recognizer,
+#endif
+#ifdef CONFIG_IQS5XX_GESTURE_THREE_FINGER
+    [3] = &three_finger_recognizer,
+#endif
+#ifdef CONFIG_IQS5XX_GESTURE_SWIPE
+    [3 ... 5] = &swipe_recognizer,
+#endif
+};
+
+// All enabled recognizers, in hardware event dispatch order
+static const struct gesture_recognizer *const recognizers[] = {
+#ifdef CONFIG_IQS5XX_GESTURE_SINGLE_FINGER
+    &single_finger_recognizer,
+#endif
+#ifdef CONFIG_IQS5XX_GESTURE_TWO_FINGER
+    &two_finger_recognizer,
+#endif
+#ifdef CONFIG_IQS5XX_GESTURE_THREE_FINGER
+    &three_finger_recognizer,
+#endif
+#ifdef CONFIG_IQS5XX_GESTURE_SWIPE
+    &swipe_recognizer,
+#endif
+};
+
+BUILD_ASSERT(TRACKPAD_PROFILE_MAX_FINGERS == GESTURE_RECOGNIZER_MAX_FINGERS &&
+             GESTURE_RECOGNIZER_MAX_FINGERS >= IQS5XX_MAX_FINGERS);
+
+void gesture_recognizer_build_owners(const struct gesture_recognizer **owners, uint8_t finger_mask) {
+    for (uint8_t n = 0; n <= GESTURE_RECOGNIZER_MAX_FINGERS; n++) {
+        owners[n] = (finger_mask & BIT(n)) ? recognizer_by_fingers[n] : NULL;
+    }
+}
+
+const struct gesture_recognizer *gesture_recognizer_for(uint8_t finger_count) {
+    if (finger_count > GESTURE_RECOGNIZER_MAX_FINGERS) {
+        return NULL;
+    }
+    return recognizer_by_fingers[finger_count];
+}
+
+// Counts each hardware gesture event bit of a frame
+static void gesture_count_events(uint32_t *counts, size_t len, uint8_t bits) {
+    for (size_t i = 0; i < len; i++) {
+        if (bits & BIT(i)) {
+            counts[i]++;
+        }
+    }
+}
+
+// True if a recognizer other than @p self holds a session
+static bool gesture_other_active(const struct gesture_recognizer *self, const struct gesture_state *state) {
+    for (size_t i = 0; i < ARRAY_SIZE(recognizers); i++) {
+        if (recognizers[i] != self && recognizers[i]->active(state)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void gesture_recognizer_init(const struct device *dev, struct gesture_state *state) {
+    for (size_t i = 0; i < ARRAY_SIZE(recognizers); i++) {
+        if (recognizers[i]->init != NULL) {
+            recognizers[i]->init(dev, state);
+        }
+    }
+}
+
+void gesture_recognizer_cancel(const struct device *dev, struct gesture_state *state) {
+    for (size_t i = 0; i < ARRAY_SIZE(recognizers); i++) {
+        const struct gesture_recognizer *r = recognizers[i];
+
+        if (!r->active(state)) {
+            continue;
+        }
+        if (r->cancel != NULL) {
+            r->cancel(dev, state);
+        } else {
+            r->reset(dev, state);
+        }
+    }
+
+    contact_tracker_reset(&state->contacts);
+    state->lastFingerCount = 0;
+}
+
+void gesture_recognizer_step(const struct device *dev, const struct iqs5xx_rawdata *data,
+                             struct gesture_state *state) {
+    struct iqs5xx_rawdata tracked;
+
+    // Once per frame for all recognizers: stable record order, deltas and velocities
+    contact_tracker_update(&state->contacts, data, gesture_uptime_get(), &tracked);
+    data = &tracked;
+
+    // The chip's relative motion was a rejected palm's, move with the finger left
+    if (tracked.rel_from_contacts && tracked.finger_count != 0) {
+        const struct tracked_contact *contact = contact_tracker_get(&state->contacts, 0);
+
+        tracked.rx = contact->dx;
+        tracked.ry = contact->dy;
+    }
+
+    if (data->finger_count != 0) {
+        for (size_t i = 0; i < ARRAY_SIZE(recognizers); i++) {
+            if (recognizers[i]->touch != NULL) {
+                recognizers[i]->touch(dev, state);
+            }
+        }
+    }
+
+    uint8_t events = (data->gestures0 ? GESTURE_RECOGNIZER_EV_GESTURES0 : 0) |
+                     (data->gestures1 ? GESTURE_RECOGNIZER_EV_GESTURES1 : 0);
+
+    // Hardware gestures first, finger lift events arrive with a count of zero
+    if (events != 0) {
+        gesture_count_events(state->stats.gestures0, ARRAY_SIZE(state->stats.gestures0), data->gestures0);
+        gesture_count_events(state->stats.gestures1, ARRAY_SIZE(state->stats.gestures1), data->gestures1);
+
+        for (size_t i = 0; i < ARRAY_SIZE(recognizers); i++) {
+            const struct gesture_recognizer *r = recognizers[i];
+
+            if ((r->events & events) == 0) {
+                continue;
+            }
+            if (r->events_exclusive && gesture_other_active(r, state)) {
+                continue;
+            }
+            r->handle(dev, data, state);
+        }
+    }
+
+    // Parsed frames never exceed IQS5XX_MAX_FINGERS, no bounds check needed
+    const struct gesture_recognizer *owner = state->profile->owners[data->finger_count];
+    // Contacts withdrawn by palm rejection rather than lifted
+    const bool cancelled = (data->finger_count == 0) && (data->system_info1 & PALM_DETECT);
+
+    // Hand the finger set over: end every other session still open
+    for (size_t i = 0; i < ARRAY_SIZE(recognizers); i++) {
+        const struct gesture_recognizer *r = recognizers[i];
+
+        if (r == owner) {
+            continue;
+        }
+        // Without an owner (lift, unsupported count) reset unconditionally
+        if (owner == NULL || r->active(state)) {
+            if (cancelled && r->cancel != NULL) {
+                r->cancel(dev, state);
+            } else {
+                r->reset(dev, state);
+            }
+        }
+    }
+
+    if (owner != NULL && (events == 0 || owner->owns_event_frames)) {
+        const bool was_active = owner->active(state);
+
+        owner->handle(dev, data, state);
+        if (!was_active && owner->active(state)) {
+            state->stats.sessions[data->finger_count]++;
+        }
+    }
+
+    state->lastFingerCount = data->finger_count;
+}
@@ -13,42 +13,157 @@
 #include <zephyr/device.h>
 #include <zephyr/devicetree.h>
 #include <zephyr/sys/util.h>
+#include <zephyr/sys/byteorder.h>
+#include <zephyr/pm/device.h>
+#include <string.h>
 #include "iqs5xx.h"
+#include "iqs5xx_capture.h"
+
+#ifdef CONFIG_IQS5XX_EVENT_MODE
+// Only assert RDY on movement, gestures and touch changes
+#define IQS5XX_SYSTEM_CONFIG1   (EVENT_MODE | TP_EVENT | GESTURE_EVENT | TOUCH_EVENT)
+#else
+#define IQS5XX_SYSTEM_CONFIG1   (TP_EVENT | TOUCH_EVENT)
+#endif
+
+// Gestures removed by the no-taps property
+#define IQS5XX_SF_TAP_GESTURES  (GESTURE_SINGLE_TAP | GESTURE_TAP_AND_HOLD)
+#define IQS5XX_MF_TAP_GESTURES  (GESTURE_TWO_FINGER_TAP)
+
+// Register configuration of an instance, resolved from devicetree at compile time
+// Swipes need all five contacts, otherwise keep the three of the register dump
+#define IQS5XX_MAX_TOUCHES_DEFAULT  (IS_ENABLED(CONFIG_IQS5XX_GESTURE_SWIPE) ? IQS5XX_MAX_FINGERS : 3)
+
+// Orientation from devicetree, rotate-90 taking precedence over rotate-180 over rotate-270
+#define IQS5XX_DT_ROT90(n)      DT_INST_PROP(n, rotate_90)
+#define IQS5XX_DT_ROT180(n)     (DT_INST_PROP(n, rotate_180) && !IQS5XX_DT_ROT90(n))
+#define IQS5XX_DT_ROT270(n)     (DT_INST_PROP(n, rotate_270) && !IQS5XX_DT_ROT90(n) && !IQS5XX_DT_ROT180(n))
+#define IQS5XX_DT_SWAP_XY(n)    (IQS5XX_DT_ROT90(n) || IQS5XX_DT_ROT270(n))
+
+// The chip flips its own axes before switching them: rotating by 90 is switch
+// plus flip X, by 270 switch plus flip Y. Inverting an output axis then flips
+// the sensor axis it was switched from.
+#define IQS5XX_DT_FLIP_X(n)                                                                     \
+    ((IQS5XX_DT_ROT90(n) || IQS5XX_DT_ROT180(n)) ^                                              \
+     (IQS5XX_DT_SWAP_XY(n) ? DT_INST_PROP(n, invert_y) : DT_INST_PROP(n, invert_x)))
+#define IQS5XX_DT_FLIP_Y(n)                                                                     \
+    ((IQS5XX_DT_ROT180(n) || IQS5XX_DT_ROT270(n)) ^                                             \
+     (IQS5XX_DT_SWAP_XY(n) ? DT_INST_PROP(n, invert_x) : DT_INST_PROP(n, invert_y)))
+
+#define IQS5XX_XY_CONFIG0_DT(n)                                                                 \
+    (PALM_REJECT |                                                                              \
+     (IQS5XX_DT_SWAP_XY(n) ? SWITCH_XY_AXIS : 0) |                                              \
+     (IQS5XX_DT_FLIP_X(n) ? FLIP_X : 0) |                                                       \
+     (IQS5XX_DT_FLIP_Y(n) ? FLIP_Y : 0))
+
+#define IQS5XX_REG_CONFIG_DT(n) {                                                               \
+    .activeRefreshRate = DT_INST_PROP_OR(n, refresh_rate_active, 5),                            \
+    .idleTouchRefreshRate = DT_INST_PROP_OR(n, refresh_rate_idle_touch, 20),                    \
+    .idleRefreshRate = DT_INST_PROP_OR(n, refresh_rate_idle, 20),                               \
+    .lp1RefreshRate = DT_INST_PROP_OR(n, refresh_rate_lp1, 80),                                 \
+    .lp2RefreshRate = DT_INST_PROP_OR(n, refresh_rate_lp2, 160),                                \
+    .activeTimeout = DT_INST_PROP_OR(n, timeout_active, 3),                                     \
+    .idleTouchTimeout = DT_INST_PROP_OR(n, timeout_idle_touch, 10),                             \
+    .idleTimeout = DT_INST_PROP_OR(n, timeout_idle, 10),                                        \
+    .lp1Timeout = DT_INST_PROP_OR(n, timeout_lp1, 3),                                           \
+    .singleFingerGestureMask = DT_INST_PROP_OR(n, single_finger_gestures,                       \
+                                               IQS5XX_SF_TAP_GESTURES) &                        \
+                               ~(DT_INST_PROP(n, no_taps) ? IQS5XX_SF_TAP_GESTURES : 0),        \
+    .multiFingerGestureMask = DT_INST_PROP_OR(n, multi_finger_gestures,                         \
+                                              GESTURE_TWO_FINGER_TAP | GESTURE_SCROLLG) &       \
+                              ~(DT_INST_PROP(n, no_taps) ? IQS5XX_MF_TAP_GESTURES : 0),         \
+    .tapTime = DT_INST_PROP_OR(n, tap_time_ms, 100),                                            \
+    .tapDistance = DT_INST_PROP_OR(n, tap_distance, 15),                                        \
+    .touchMultiplier = DT_INST_PROP_OR(n, touch_multiplier, 0),                                 \
+    .debounce = DT_INST_PROP_OR(n, debounce, 0),                                                \
+    .i2cTimeout = DT_INST_PROP_OR(n, i2c_timeout_ms, 10),                                       \
+    .systemConfig1 = IQS5XX_SYSTEM_CONFIG1,                                                     \
+    .filterSettings = DT_INST_PROP_OR(n, filter_settings, MAV_FILTER | IIR_FILTER),             \
+    .filterDynBottomBeta = DT_INST_PROP_OR(n, filter_dynamic_bottom_beta, 15),                  \
+    .filterDynLowerSpeed = DT_INST_PROP_OR(n, filter_dynamic_lower_speed, 10),                  \
+    .filterDynUpperSpeed = DT_INST_PROP_OR(n, filter_dynamic_upper_speed, 200),                 \
+    .hardwareSettingsA = DT_INST_PROP_OR(n, hardware_settings_a, 0),                            \
+    .xyConfig0 = IQS5XX_XY_CONFIG0_DT(n),                                                       \
+    .maxMultitouches = DT_INST_PROP_OR(n, max_touches, IQS5XX_MAX_TOUCHES_DEFAULT),             \
+    .palmRejectThreshold = DT_INST_PROP_OR(n, palm_reject_threshold, 25),                       \
+    .palmRejectTimeout = DT_INST_PROP_OR(n, palm_reject_timeout, 15),                           \
+    .initScrollDistance = DT_INST_PROP_OR(n, scroll_init_distance, 10),                         \
+}
+
+#ifdef CONFIG_IQS5XX_PALM_FILTER
+/**
+ * @brief Palm rejection stage, run on every parsed frame before it is queued.
+ * Masks contacts failing the area and strength limits, and all contacts from
+ * the chip flagging a palm (or too many fingers) until the next full lift.
+ * Withdrawn contacts end in a single lift frame with PALM_DETECT set, so
+ * gesture code cancels its session instead of acting on the lift.
+ *
+ * @return 0 to pass the frame on, -ENODATA to drop it
+ */
+static int iqs5xx_palm_filter(const struct device *dev, struct iqs5xx_rawdata *frame) {
+    struct iqs5xx_data *data = dev->data;
+    const struct iqs5xx_config *config = dev->config;
+    const uint8_t contacts = frame->finger_count;
+    uint8_t kept = 0;
 
+    if (contacts == 0) {
+        data->palm_active = false;
+    } else if (frame->system_info1 & (PALM_DETECT | TOO_MANY_FINGERS)) {
+        data->palm_active = true;
+    }
+
+    if (!data->palm_active) {
+        for (uint8_t i = 0; i < contacts; i++) {
+            const struct iqs5xx_finger *finger = &frame->fingers[i];
+
+            if ((config->palm_area_max != 0 && finger->area > config->palm_area_max) ||
+                finger->strength < config->finger_strength_min) {
+                if (i == 0) {
+                    // Relative motion is the first contact's, the tracker has the kept ones'
+                    frame->rel_from_contacts = true;
+                }
+                continue;
+            }
+            frame->fingers[kept++] = *finger;
+        }
+    }
+
+    if (kept == contacts) {
+        data->reported_finger_count = contacts;
+        return 0;
+    }
 
-static int iqs_regdump_err = 0;
+    data->palm_frames++;
 
-// Default config
-struct iqs5xx_reg_config iqs5xx_reg_config_default () {
-    struct iqs5xx_reg_config regconf;
+    // Hardware gestures may stem from the rejected contacts
+    frame->gestures0 = 0;
+    frame->gestures1 = 0;
+    frame->finger_count = kept;
+    memset(&frame->fingers[kept], 0, sizeof(frame->fingers[0]) * (IQS5XX_MAX_FINGERS - kept));
 
-        regconf.activeRefreshRate =         5;    // Increased from 10 for faster response
-        regconf.idleRefreshRate =           20;   // Increased from 50
-        regconf.singleFingerGestureMask =   GESTURE_SINGLE_TAP | GESTURE_TAP_AND_HOLD;
-        regconf.multiFingerGestureMask =    GESTURE_TWO_FINGER_TAP | GESTURE_SCROLLG;
-        regconf.tapTime =                   100;  // Reduced for faster taps
-        regconf.tapDistance =               15;   // Reduced for more sensitive taps
-        regconf.touchMultiplier =           0;
-        regconf.debounce =                  0;
-        regconf.i2cTimeout =                10;   // Increased for better reliability
-        regconf.filterSettings =            MAV_FILTER | IIR_FILTER;
-        regconf.filterDynBottomBeta =        15;  // Reduced for less filtering
-        regconf.filterDynLowerSpeed =        10;  // Reduced for faster response
-        regconf.filterDynUpperSpeed =        200; // Increased for better fast movements
-        regconf.initScrollDistance =        10;   // Reduced for easier scrolling
+    if (kept == 0) {
+        if (data->reported_finger_count == 0) {
+            return -ENODATA;
+        }
+        frame->rx = 0;
+        frame->ry = 0;
+        frame->system_info1 |= PALM_DETECT;
+    }
 
-        return regconf;
+    data->reported_finger_count = kept;
+    return 0;
 }
+#endif
 
 /**
  * @brief Read from the iqs550 chip via i2c
  */
 static int iqs5xx_seq_read(const struct device *dev, const uint16_t start, uint8_t *read_buf,
                            const uint8_t len) {
-    const struct iqs5xx_data *data = dev->data;
+    const struct iqs5xx_config *config = dev->config;
     uint16_t nstart = (start << 8 ) | (start >> 8);
 
-    int ret = i2c_write_read(data->i2c, AZOTEQ_IQS5XX_ADDR, &nstart, sizeof(nstart), read_buf, len);
+    int ret = i2c_write_read_dt(&config->i2c, &nstart, sizeof(nstart), read_buf, len);
     return ret;
 }
 
@@ -58,7 +173,7 @@ static int iqs5xx_seq_read(const struct device *dev, const uint16_t start, uint8
 static int iqs5xx_write(const struct device *dev, const uint16_t start_addr, const uint8_t *buf,
                         uint32_t num_bytes) {
 
-    const struct iqs5xx_data *data = dev->data;
+    const struct iqs5xx_config *config = dev->config;
 
     uint8_t addr_buffer[2];
     struct i2c_msg msg[2];
@@ -73,137 +188,574 @@ static int iqs5xx_write(const struct device *dev, const uint16_t start_addr, con
     msg[1].len = num_bytes;
     msg[1].flags = I2C_MSG_WRITE | I2C_MSG_STOP;
 
-    int err = i2c_transfer(data->i2c, msg, 2, AZOTEQ_IQS5XX_ADDR);
+    int err = i2c_transfer_dt(&config->i2c, msg, 2);
     return err;
 }
 
-static int iqs5xx_reg_dump (const struct device *dev) {
-    int ret = iqs5xx_write(dev, IQS5XX_REG_DUMP_START_ADDRESS, _iqs5xx_regdump, IQS5XX_REG_DUMP_SIZE);
-    return ret;
+// END_WINDOW address followed by the data byte closing the communication window
+static const uint8_t iqs5xx_end_window_msg[] = { END_WINDOW >> 8, END_WINDOW & 0xFF, 0x00 };
+
+/**
+ * @brief Closes the communication window
+ */
+static int iqs5xx_end_window(const struct device *dev) {
+    return iqs5xx_write(dev, END_WINDOW, &iqs5xx_end_window_msg[2], 1);
+}
+
+/**
+ * @brief Counts the status flags of a frame header read from GestureEvents0_adr
+ */
+static void iqs5xx_count_status(struct iqs5xx_data *data, const uint8_t *buffer) {
+    if (buffer[2] & (ATI_ERROR | ALP_ATI_ERROR)) {
+        data->ati_errors++;
+    }
+    if (buffer[2] & (REATI_OCCURRED | ALP_REATI_OCCURRED)) {
+        data->reati_events++;
+    }
+    if (buffer[3] & RR_MISSED) {
+        data->rr_missed++;
+    }
+}
+
+/**
+ * @brief Adds a frame read started at the given cycle count to the bus time
+ */
+static inline void iqs5xx_count_bus_time(struct iqs5xx_data *data, uint32_t start) {
+    data->bus_cycles += k_cycle_get_32() - start;
+    data->bus_reads++;
+}
+
+/**
+ * @brief Whether a frame header shows no movement, gesture or finger count change.
+ * Such frames are dropped after the header read.
+ */
+static bool iqs5xx_frame_unchanged(struct iqs5xx_data *data, const uint8_t *buffer) {
+    const uint8_t finger_count = MIN(buffer[4], IQS5XX_MAX_FINGERS);
+
+    if ((buffer[3] & TP_MOVEMENT) || buffer[0] != 0 || buffer[1] != 0 ||
+        finger_count != data->last_finger_count) {
+        return false;
+    }
+
+    data->frames_unchanged++;
+    return true;
+}
+
+/**
+ * @brief Parses a frame read from GestureEvents0_adr and runs the frame filters
+ *
+ * @return 0 to pass the frame on, -ENODATA to drop it
+ */
+static int iqs5xx_parse_frame(const struct device *dev, const uint8_t *buffer,
+                              struct iqs5xx_rawdata *frame) {
+    struct iqs5xx_data *data = dev->data;
+    const uint8_t finger_count = MIN(buffer[4], IQS5XX_MAX_FINGERS);
+
+    frame->gestures0 =      buffer[0];
+    frame->gestures1 =      buffer[1];
+    frame->system_info0 =   buffer[2];
+    frame->system_info1 =   buffer[3];
+    frame->finger_count =   finger_count;
+    frame->rel_from_contacts = false;
+    data->last_finger_count = finger_count;
+
+    // Parse relative movement (signed 16-bit values), already oriented by XYConfig0
+    frame->rx = (int16_t)(buffer[5] << 8 | buffer[6]);
+    frame->ry = (int16_t)(buffer[7] << 8 | buffer[8]);
+
+    for(int i = 0; i < finger_count; i++) {
+        const int p = IQS5XX_FRAME_HEADER_LEN + (IQS5XX_FINGER_RECORD_LEN * i);
+        frame->fingers[i].ax = buffer[p + 0] << 8 | buffer[p + 1];
+        frame->fingers[i].ay = buffer[p + 2] << 8 | buffer[p + 3];
+        frame->fingers[i].strength = buffer[p + 4] << 8 | buffer[p + 5];
+        frame->fingers[i].area= buffer[p + 6];
+    }
+
+    // Slots that were not read hold no contact
+    memset(&frame->fingers[finger_count], 0,
+           sizeof(frame->fingers[0]) * (IQS5XX_MAX_FINGERS - finger_count));
+
+    iqs5xx_capture_frame(dev, frame);
+
+#ifdef CONFIG_IQS5XX_PALM_FILTER
+    int res = iqs5xx_palm_filter(dev, frame);
+    if (res < 0) {
+        return res;
+    }
+#endif
+
+    iqs5xx_latency_mark(dev, IQS5XX_LAT_PARSE_DONE);
+    return 0;
 }
 
+#ifndef CONFIG_IQS5XX_I2C_ASYNC
 /**
  * @brief Read data from IQS5XX
+ *
+ * Reads the frame header plus as many finger records as the previous frame
+ * reported, and tops up the missing records in the same communication window
+ * if the finger count grew.
 */
-static int iqs5xx_sample_fetch (const struct device *dev) {
-     uint8_t buffer[44];
+static int iqs5xx_sample_fetch (const struct device *dev, struct iqs5xx_rawdata *frame) {
+        uint8_t buffer[IQS5XX_FRAME_MAX_LEN];
         struct iqs5xx_data *data = dev->data;
-        const struct iqs5xx_config *config = dev->config;
 
-        int res = iqs5xx_seq_read(dev, GestureEvents0_adr, buffer, 44);
-        iqs5xx_write(dev, END_WINDOW, 0, 1);
+        const uint8_t predicted = MIN(data->last_finger_count, IQS5XX_MAX_FINGERS);
+        const uint32_t start = k_cycle_get_32();
+        int res = iqs5xx_seq_read(dev, GestureEvents0_adr, buffer,
+                                  IQS5XX_FRAME_HEADER_LEN + IQS5XX_FINGER_RECORD_LEN * predicted);
+
+        if (res == 0) {
+            iqs5xx_count_status(data, buffer);
+        }
+
+        // Nothing moved, no gesture and the same fingers, skip the frame
+        if (res == 0 && iqs5xx_frame_unchanged(data, buffer)) {
+            iqs5xx_end_window(dev);
+            iqs5xx_count_bus_time(data, start);
+            return -ENODATA;
+        }
+
+        const uint8_t finger_count = MIN(buffer[4], IQS5XX_MAX_FINGERS);
+        if (res == 0 && finger_count > predicted) {
+            const uint8_t offset = IQS5XX_FRAME_HEADER_LEN + IQS5XX_FINGER_RECORD_LEN * predicted;
+            res = iqs5xx_seq_read(dev, GestureEvents0_adr + offset, buffer + offset,
+                                  IQS5XX_FINGER_RECORD_LEN * (finger_count - predicted));
+        }
+        iqs5xx_end_window(dev);
+        iqs5xx_count_bus_time(data, start);
+        iqs5xx_latency_mark(dev, IQS5XX_LAT_I2C_DONE);
 
         if (res < 0) {
             return res;
         }
 
-        // Parse data
-        data->raw_data.gestures0 =      buffer[0];
-        data->raw_data.gestures1 =      buffer[1];
-        data->raw_data.system_info0 =   buffer[2];
-        data->raw_data.system_info1 =   buffer[3];
-        data->raw_data.finger_count =   buffer[4];
+        return iqs5xx_parse_frame(dev, buffer, frame);
+}
+#endif
+
+/**
+ * @brief Workqueue running the fetch and bring-up work items
+ */
+static inline struct k_work_q *iqs5xx_workq(struct iqs5xx_data *data) {
+#ifdef CONFIG_IQS5XX_TRIGGER_OWN_THREAD
+    return &data->workq;
+#else
+    return &k_sys_work_q;
+#endif
+}
+
+/**
+ * @brief Submits the fetch work item to the configured workqueue
+ */
+static inline void iqs5xx_submit(struct iqs5xx_data *data) {
+    k_work_submit_to_queue(iqs5xx_workq(data), &data->work);
+}
+
+#ifdef CONFIG_IQS5XX_I2C_ASYNC
+// async_flags bits
+enum {
+    // A chained frame read owns the bus
+    IQS5XX_ASYNC_INFLIGHT,
+    // A data ready edge arrived while a thread held the bus
+    IQS5XX_ASYNC_PENDING,
+};
+#endif
+
+/**
+ * @brief Takes the bus for a transaction
+ */
+static inline int iqs5xx_bus_lock(struct iqs5xx_data *data, k_timeout_t timeout) {
+#ifdef CONFIG_IQS5XX_I2C_ASYNC
+    return k_sem_take(&data->bus_sem, timeout);
+#else
+    return k_mutex_lock(&data->i2c_mutex, timeout);
+#endif
+}
 
-        // Parse relative movement (signed 16-bit values)
-        int16_t raw_rx = (int16_t)(buffer[5] << 8 | buffer[6]);
-        int16_t raw_ry = (int16_t)(buffer[7] << 8 | buffer[8]);
+/**
+ * @brief Releases the bus
+ */
+static inline void iqs5xx_bus_unlock(struct iqs5xx_data *data) {
+#ifdef CONFIG_IQS5XX_I2C_ASYNC
+    k_sem_give(&data->bus_sem);
 
-        // Apply coordinate transformation to relative movement
-        struct coord_transform rel_transformed = apply_coordinate_transform(raw_rx, raw_ry, config);
-        data->raw_data.rx = rel_transformed.x;
-        data->raw_data.ry = rel_transformed.y;
+    // The data ready edge found the bus taken, read that window from the workqueue
+    if (atomic_test_and_clear_bit(&data->async_flags, IQS5XX_ASYNC_PENDING)) {
+        iqs5xx_submit(data);
+    }
+#else
+    k_mutex_unlock(&data->i2c_mutex);
+#endif
+}
 
-        for(int i = 0; i < 5; i++) {
-            const int p = 9 + (7 * i);
-            data->raw_data.fingers[i].ax = buffer[p + 0] << 8 | buffer[p + 1];
-            data->raw_data.fingers[i].ay = buffer[p + 2] << 8 | buffer[p + 3];
-            data->raw_data.fingers[i].strength = buffer[p + 4] << 8 | buffer[p + 5];
-            data->raw_data.fingers[i].area= buffer[p + 6];
+#ifdef CONFIG_IQS5XX_POLL
+/**
+ * @brief Schedules the next poll on the configured workqueue
+ */
+static inline void iqs5xx_schedule_poll(struct iqs5xx_data *data, k_timeout_t delay) {
+    k_work_reschedule_for_queue(iqs5xx_workq(data), &data->poll_work, delay);
+}
+#endif
+
+/**
+ * @brief Enables or disables the data ready trigger (interrupt or poll loop)
+ */
+static void iqs5xx_trigger_enable(struct iqs5xx_data *data, bool enable) {
+    data->trigger_enabled = enable;
+
+#ifdef CONFIG_IQS5XX_POLL
+    if (enable) {
+        data->poll_misses = 0;
+        iqs5xx_schedule_poll(data, K_NO_WAIT);
+    } else {
+        k_work_cancel_delayable(&data->poll_work);
+    }
+#else
+    const struct iqs5xx_config *config = data->dev->config;
+
+    gpio_pin_interrupt_configure_dt(&config->dr, enable ? GPIO_INT_EDGE_TO_ACTIVE : GPIO_INT_DISABLE);
+#endif
+}
+
+/**
+ * @brief Schedules the next bring-up step on the configured workqueue
+ */
+static inline void iqs5xx_schedule_recovery(struct iqs5xx_data *data, k_timeout_t delay) {
+    k_work_reschedule_for_queue(iqs5xx_workq(data), &data->recovery_work, delay);
+}
+
+/**
+ * @brief Stops the data ready trigger and starts the bring-up state machine
+ */
+static void iqs5xx_recovery_start(struct iqs5xx_data *data) {
+    iqs5xx_trigger_enable(data, false);
+
+    data->consecutive_errors = 0;
+    data->recovery_attempts = 0;
+    data->recovery_state = IQS5XX_RECOVERY_RESET;
+    iqs5xx_schedule_recovery(data, K_NO_WAIT);
+}
+
+BUILD_ASSERT(IS_POWER_OF_TWO(CONFIG_IQS5XX_FRAME_RING_SIZE),
+             "CONFIG_IQS5XX_FRAME_RING_SIZE must be a power of two");
+
+#define IQS5XX_FRAME_SLOT(index)    ((index) & (CONFIG_IQS5XX_FRAME_RING_SIZE - 1))
+
+/**
+ * @brief Slot the next frame is fetched into, the overrun slot while the ring is full
+ */
+static struct iqs5xx_frame *iqs5xx_fetch_slot(struct iqs5xx_data *data) {
+    // Only the fetch side advances the head, the dispatch side only advances the tail
+    const atomic_val_t head = atomic_get(&data->frame_head);
+
+    if ((head - atomic_get(&data->frame_tail)) >= CONFIG_IQS5XX_FRAME_RING_SIZE) {
+        return &data->overrun_frame;
+    }
+    return &data->frames[IQS5XX_FRAME_SLOT(head)];
+}
 
-            // Apply finger coordinate transformation
-            apply_finger_transform(&data->raw_data.fingers[i], config);
+/**
+ * @brief Queues a fetched frame for dispatch, or counts the failed read and
+ * hands over to recovery once too many failed in a row
+ */
+static void iqs5xx_frame_fetched(struct iqs5xx_data *data, struct iqs5xx_frame *slot, int ret) {
+    if (ret < 0 && ret != -ENODATA) {
+        data->errors.i2c_errors++;
+
+        // Hand over to the recovery state machine rather than waiting here
+        if (++data->consecutive_errors >= CONFIG_IQS5XX_RECOVERY_ERROR_THRESHOLD) {
+            data->errors.recoveries++;
+            iqs5xx_recovery_start(data);
         }
+        return;
+    }
 
-        return 0;
+    data->consecutive_errors = 0;
+
+    if (ret == -ENODATA) {
+        return; // Empty frame, nothing to dispatch
+    }
+
+    if (slot == &data->overrun_frame) {
+        // Dispatch is behind, drop the frame rather than stall the bus
+        data->frame_overruns++;
+        return;
+    }
+
+    data->frames_fetched++;
+#ifdef CONFIG_IQS5XX_LATENCY_STATS
+    iqs5xx_latency_publish(data->dev, &slot->lat);
+#endif
+    atomic_inc(&data->frame_head);
+    // Gesture processing always runs on the system workqueue, in every trigger
+    // mode. The scroll coast, the keystroke player and the trackpad's profile
+    // and typing guard work share its state without locks.
+    k_work_submit_to_queue(&k_sys_work_q, &data->process_work);
 }
 
-static void iqs5xx_work_cb(struct k_work *work) {
-    struct iqs5xx_data *data = CONTAINER_OF(work, struct iqs5xx_data, work);
+#ifndef CONFIG_IQS5XX_I2C_ASYNC
+/**
+ * @brief Fetches a frame into the frame ring. The bus is released as soon as
+ * the I2C transaction is done, gesture processing runs from process_work.
+ */
+static void iqs5xx_process(struct iqs5xx_data *data) {
+    iqs5xx_latency_mark(data->dev, IQS5XX_LAT_WORK_START);
+
+    // A frame queued before the trigger was stopped, the bus belongs to recovery
+    if (data->recovery_state != IQS5XX_RECOVERY_IDLE) {
+        return;
+    }
 
-    k_mutex_lock(&data->i2c_mutex, K_MSEC(1000));
-    int ret = iqs5xx_sample_fetch(data->dev);
+    struct iqs5xx_frame *slot = iqs5xx_fetch_slot(data);
 
-    if (ret == 0) {
-        // Success - reset error counter
-        data->consecutive_errors = 0;
+    // The window closes before a thread holding the bus this long lets go, skip it
+    if (iqs5xx_bus_lock(data, K_MSEC(1000)) != 0) {
+        return;
+    }
+    int ret = iqs5xx_sample_fetch(data->dev, &slot->raw);
+    iqs5xx_bus_unlock(data);
 
-        if (data->data_ready_handler != NULL) {
-            data->data_ready_handler(data->dev, &data->raw_data);
-        } else {
+    iqs5xx_frame_fetched(data, slot, ret);
+}
+#endif
+
+#ifdef CONFIG_IQS5XX_I2C_ASYNC
+static void iqs5xx_async_done(const struct device *i2c, int result, void *userdata);
+
+/**
+ * @brief Starts the chained frame read and END_WINDOW write. The caller holds
+ * the bus, the completion callback releases it.
+ *
+ * @param records Finger records to read after the header
+ */
+static void iqs5xx_async_read(struct iqs5xx_data *data, uint8_t records) {
+    const struct iqs5xx_config *config = data->dev->config;
+
+    atomic_set_bit(&data->async_flags, IQS5XX_ASYNC_INFLIGHT);
+    iqs5xx_latency_mark(data->dev, IQS5XX_LAT_WORK_START);
+
+    sys_put_be16(GestureEvents0_adr, data->async_addr);
+    data->async_records = records;
+    data->async_start = k_cycle_get_32();
+
+    data->async_msgs[0].buf = data->async_addr;
+    data->async_msgs[0].len = sizeof(data->async_addr);
+    data->async_msgs[0].flags = I2C_MSG_WRITE;
+
+    data->async_msgs[1].buf = data->async_buf;
+    data->async_msgs[1].len = IQS5XX_FRAME_HEADER_LEN + IQS5XX_FINGER_RECORD_LEN * records;
+    data->async_msgs[1].flags = I2C_MSG_READ | I2C_MSG_RESTART | I2C_MSG_STOP;
+
+    data->async_msgs[2].buf = (uint8_t *)iqs5xx_end_window_msg;
+    data->async_msgs[2].len = sizeof(iqs5xx_end_window_msg);
+    data->async_msgs[2].flags = I2C_MSG_WRITE | I2C_MSG_STOP;
+
+    int ret = i2c_transfer_cb_dt(&config->i2c, data->async_msgs, ARRAY_SIZE(data->async_msgs),
+                                 iqs5xx_async_done, data);
+    if (ret < 0) {
+        atomic_clear_bit(&data->async_flags, IQS5XX_ASYNC_INFLIGHT);
+        iqs5xx_bus_unlock(data);
+        iqs5xx_frame_fetched(data, NULL, ret);
+    }
+}
+
+/**
+ * @brief Records to read for the next frame: one more than the last frame
+ * reported, so a new contact fits in the same transaction
+ */
+static inline uint8_t iqs5xx_async_records(const struct iqs5xx_data *data) {
+    return MIN(data->last_finger_count + 1, IQS5XX_MAX_FINGERS);
+}
+
+/**
+ * @brief Completion of the chained read, parses the frame in the callback context
+ */
+static void iqs5xx_async_done(const struct device *i2c, int result, void *userdata) {
+    struct iqs5xx_data *data = userdata;
+
+    iqs5xx_latency_mark(data->dev, IQS5XX_LAT_I2C_DONE);
+    iqs5xx_count_bus_time(data, data->async_start);
+
+    if (result < 0) {
+        atomic_clear_bit(&data->async_flags, IQS5XX_ASYNC_INFLIGHT);
+        iqs5xx_bus_unlock(data);
+        iqs5xx_frame_fetched(data, NULL, result);
+        return;
+    }
+
+    const uint8_t finger_count = MIN(data->async_buf[4], IQS5XX_MAX_FINGERS);
+    if (finger_count > data->async_records) {
+        // The window is closed already. A read started outside a window is held
+        // by the chip until the next one, so read that frame in full instead.
+        data->async_rereads++;
+        iqs5xx_async_read(data, finger_count);
+        return;
+    }
+
+    iqs5xx_count_status(data, data->async_buf);
+
+    struct iqs5xx_frame *slot = iqs5xx_fetch_slot(data);
+    int ret = -ENODATA;
+
+    // Nothing moved, no gesture and the same fingers, skip the frame
+    if (!iqs5xx_frame_unchanged(data, data->async_buf)) {
+        ret = iqs5xx_parse_frame(data->dev, data->async_buf, &slot->raw);
+    }
+
+    atomic_clear_bit(&data->async_flags, IQS5XX_ASYNC_INFLIGHT);
+    iqs5xx_bus_unlock(data);
+    iqs5xx_frame_fetched(data, slot, ret);
+}
+
+/**
+ * @brief Starts reading the open window from the data ready ISR
+ */
+static void iqs5xx_async_trigger(struct iqs5xx_data *data) {
+    // The transfer in flight, or the recovery owning the chip, covers this edge
+    if (data->recovery_state != IQS5XX_RECOVERY_IDLE ||
+        atomic_test_bit(&data->async_flags, IQS5XX_ASYNC_INFLIGHT)) {
+        return;
+    }
+
+    if (k_sem_take(&data->bus_sem, K_NO_WAIT) != 0) {
+        // Leave the window to the thread holding the bus, unless it just let go
+        atomic_set_bit(&data->async_flags, IQS5XX_ASYNC_PENDING);
+        if (k_sem_take(&data->bus_sem, K_NO_WAIT) != 0) {
             return;
         }
-    } else {
-        // I2C Error handling
-        data->consecutive_errors++;
-        int64_t current_time = k_uptime_get();
+        atomic_clear_bit(&data->async_flags, IQS5XX_ASYNC_PENDING);
+    }
+
+    iqs5xx_async_read(data, iqs5xx_async_records(data));
+}
+
+/**
+ * @brief Reads a window whose data ready edge found the bus taken by a thread
+ */
+static void iqs5xx_async_pending(struct iqs5xx_data *data) {
+    const struct iqs5xx_config *config = data->dev->config;
 
-        // If we have too many consecutive errors, try recovery
-        if (data->consecutive_errors >= 15) {
-            // Reset error counter
-            data->consecutive_errors = 0;
-            data->last_error_time = current_time;
+    if (data->recovery_state != IQS5XX_RECOVERY_IDLE ||
+        iqs5xx_bus_lock(data, K_MSEC(1000)) != 0) {
+        return;
+    }
+
+    // Already read by an edge handled meanwhile, don't wait for the next window
+    if (gpio_pin_get_dt(&config->dr) <= 0) {
+        iqs5xx_bus_unlock(data);
+        return;
+    }
 
-            k_mutex_unlock(&data->i2c_mutex);
+    iqs5xx_async_read(data, iqs5xx_async_records(data));
+}
+#endif
+
+/**
+ * @brief Passes fetched frames to the trigger handler, oldest first
+ */
+static void iqs5xx_process_work_cb(struct k_work *work) {
+    struct iqs5xx_data *data = CONTAINER_OF(work, struct iqs5xx_data, process_work);
+    atomic_val_t tail = atomic_get(&data->frame_tail);
 
-            // Get config for GPIO access
-            const struct iqs5xx_config *config = data->dev->config;
+    while (tail != atomic_get(&data->frame_head)) {
+        struct iqs5xx_frame *slot = &data->frames[IQS5XX_FRAME_SLOT(tail)];
 
-            // Disable interrupts temporarily
-            gpio_pin_interrupt_configure_dt(&config->dr, GPIO_INT_DISABLE);
+#ifdef CONFIG_IQS5XX_LATENCY_STATS
+        iqs5xx_latency_consume(data->dev, &slot->lat);
+#endif
+        if (data->data_ready_handler != NULL) {
+            data->data_ready_handler(data->dev, &slot->raw);
+        }
 
-            // Wait for device to settle
-            k_msleep(200);
+        iqs5xx_latency_mark(data->dev, IQS5XX_LAT_DISPATCH_DONE);
+        iqs5xx_latency_frame_end(data->dev);
 
-            // Try a simple reset by writing to system control
-            uint8_t reset_cmd = RESET_TP;
-            iqs5xx_write(data->dev, SystemControl1_adr, &reset_cmd, 1);
-            iqs5xx_write(data->dev, END_WINDOW, 0, 1);
+        // Hand the slot back to the fetch side
+        atomic_set(&data->frame_tail, ++tail);
+    }
+}
 
-            // Wait after reset
-            k_msleep(100);
+static void iqs5xx_work_cb(struct k_work *work) {
+    struct iqs5xx_data *data = CONTAINER_OF(work, struct iqs5xx_data, work);
 
-            // Re-enable interrupts
-            gpio_pin_interrupt_configure_dt(&config->dr, GPIO_INT_EDGE_TO_ACTIVE);
+#ifdef CONFIG_IQS5XX_I2C_ASYNC
+    iqs5xx_async_pending(data);
+#else
+    iqs5xx_process(data);
+#endif
+}
 
+#ifdef CONFIG_IQS5XX_POLL
+/**
+ * @brief Poll loop. Samples the data ready pin in a short window once each
+ * refresh period has elapsed, and backs off to the idle refresh period once
+ * no finger has been seen for a while.
+ */
+static void iqs5xx_poll_work_cb(struct k_work *work) {
+    struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+    struct iqs5xx_data *data = CONTAINER_OF(dwork, struct iqs5xx_data, poll_work);
+    const struct iqs5xx_config *config = data->dev->config;
+
+    if (gpio_pin_get_dt(&config->dr) <= 0) {
+        // Cycle not finished yet, retry within the window, then wait a full period
+        if (++data->poll_misses < CONFIG_IQS5XX_POLL_WINDOW_MS) {
+            iqs5xx_schedule_poll(data, K_MSEC(1));
             return;
         }
+    } else {
+        iqs5xx_process(data);
 
-        // If errors persist for too long, disable temporarily
-        if ((current_time - data->last_error_time > 3000) && (data->consecutive_errors > 5)) {
-            const struct iqs5xx_config *config = data->dev->config;
-            gpio_pin_interrupt_configure_dt(&config->dr, GPIO_INT_DISABLE);
-
-            k_mutex_unlock(&data->i2c_mutex);
-            k_msleep(500);
-            k_mutex_lock(&data->i2c_mutex, K_MSEC(1000));
+        // Recovery took over the bus, it restarts the loop once the chip is back
+        if (data->recovery_state != IQS5XX_RECOVERY_IDLE) {
+            return;
+        }
+    }
 
-            gpio_pin_interrupt_configure_dt(&config->dr, GPIO_INT_EDGE_TO_ACTIVE);
-            data->consecutive_errors = 0;
-            data->last_error_time = current_time;
+    // An empty window counts as idle too, in event mode the chip stays quiet without a finger
+    if (data->last_finger_count == 0) {
+        if (data->poll_idle_frames < UINT8_MAX) {
+            data->poll_idle_frames++;
         }
+    } else {
+        data->poll_idle_frames = 0;
     }
 
-    k_mutex_unlock(&data->i2c_mutex);
+    data->poll_misses = 0;
+
+    uint16_t period = (data->poll_idle_frames >= CONFIG_IQS5XX_POLL_IDLE_FRAMES) ?
+                      data->idle_rr : data->active_rr;
+    iqs5xx_schedule_poll(data, K_MSEC(period));
 }
+#endif
 
+#ifndef CONFIG_IQS5XX_POLL
 /**
  * @brief Called when data ready pin goes active. Submits work to workqueue.
  */
 static void iqs5xx_gpio_cb(const struct device *port, struct gpio_callback *cb, uint32_t pins) {
     struct iqs5xx_data *data = CONTAINER_OF(cb, struct iqs5xx_data, dr_cb);
 
-    k_work_submit(&data->work);
+    // A register write waits for this window, there is no frame to fetch
+    if (atomic_get(&data->ready_wait)) {
+        k_sem_give(&data->ready_sem);
+        return;
+    }
+
+    // Bring-up waits for the first window after a reset
+    if (data->recovery_state == IQS5XX_RECOVERY_WAIT_READY) {
+        iqs5xx_schedule_recovery(data, K_NO_WAIT);
+        return;
+    }
+
+    iqs5xx_latency_mark(data->dev, IQS5XX_LAT_ISR);
+#ifdef CONFIG_IQS5XX_I2C_ASYNC
+    iqs5xx_async_trigger(data);
+#else
+    iqs5xx_submit(data);
+#endif
 }
+#endif
 
 /**
  * @brief Sets the trigger handler
@@ -214,207 +766,655 @@ int iqs5xx_trigger_set(const struct device *dev, iqs5xx_trigger_handler_t handle
     return 0;
 }
 
+// Register field of struct iqs5xx_reg_config, stored big-endian on the device
+struct iqs5xx_reg_field {
+    uint16_t addr;
+    uint8_t size;
+    uint8_t offset;
+};
+
+#define IQS5XX_REG_FIELD(_addr, _member) {                              \
+        .addr = (_addr),                                                \
+        .size = sizeof(((struct iqs5xx_reg_config *)0)->_member),       \
+        .offset = offsetof(struct iqs5xx_reg_config, _member),          \
+    }
+
+// Sorted by address, so changed fields can be merged into spans
+static const struct iqs5xx_reg_field iqs5xx_config_fields[] = {
+    IQS5XX_REG_FIELD(ActiveRR_adr,          activeRefreshRate),
+    IQS5XX_REG_FIELD(IdleTouchRR_adr,       idleTouchRefreshRate),
+    IQS5XX_REG_FIELD(IdleRR_adr,            idleRefreshRate),
+    IQS5XX_REG_FIELD(LP1RR_adr,             lp1RefreshRate),
+    IQS5XX_REG_FIELD(LP2RR_adr,             lp2RefreshRate),
+    IQS5XX_REG_FIELD(ActiveTimeout_adr,     activeTimeout),
+    IQS5XX_REG_FIELD(IdleTouchTimeout_adr,  idleTouchTimeout),
+    IQS5XX_REG_FIELD(IdleTimeout_adr,       idleTimeout),
+    IQS5XX_REG_FIELD(LP1Timeout_adr,        lp1Timeout),
+    IQS5XX_REG_FIELD(I2CTimeout_adr,        i2cTimeout),
+    IQS5XX_REG_FIELD(SystemConfig1_adr,     systemConfig1),
+    IQS5XX_REG_FIELD(GlobalTouchSet_adr,    touchMultiplier),
+    IQS5XX_REG_FIELD(FilterSettings0_adr,   filterSettings),
+    IQS5XX_REG_FIELD(DynamicBottomBeta_adr, filterDynBottomBeta),
+    IQS5XX_REG_FIELD(DynamicLowerSpeed_adr, filterDynLowerSpeed),
+    IQS5XX_REG_FIELD(DynamicUpperSpeed_adr, filterDynUpperSpeed),
+    IQS5XX_REG_FIELD(HardwareSettingsA_adr, hardwareSettingsA),
+    IQS5XX_REG_FIELD(XYConfig0_adr,         xyConfig0),
+    IQS5XX_REG_FIELD(MaxMultitouches_adr,   maxMultitouches),
+    IQS5XX_REG_FIELD(PalmRejectThreshold_adr, palmRejectThreshold),
+    IQS5XX_REG_FIELD(PalmRejectTimeout_adr, palmRejectTimeout),
+    IQS5XX_REG_FIELD(ProxDb_adr,            debounce),
+    IQS5XX_REG_FIELD(TouchSnapDb_adr,       debounce),
+    IQS5XX_REG_FIELD(SFGestureEnable_adr,   singleFingerGestureMask),
+    IQS5XX_REG_FIELD(MFGestureEnable_adr,   multiFingerGestureMask),
+    IQS5XX_REG_FIELD(TapTime_adr,           tapTime),
+    IQS5XX_REG_FIELD(TapDistance_adr,       tapDistance),
+    IQS5XX_REG_FIELD(ScrollInitDistance_adr, initScrollDistance),
+};
+
+// Config fields are part of the register image, so they must lie inside the dump
+BUILD_ASSERT(ActiveRR_adr >= IQS5XX_REG_DUMP_START_ADDRESS &&
+             ScrollInitDistance_adr + 2 <= IQS5XX_REG_DUMP_START_ADDRESS + IQS5XX_REG_DUMP_SIZE);
+
+// Unchanged bytes between two changed fields are rewritten rather than
+// starting a new transaction, up to the size of an address header and STOP
+#define IQS5XX_SPAN_MERGE_GAP   3
+
 /**
- * @brief Sets registers to initial values
+ * @brief Serializes a config field into the register image
+ *
+ * @return true if the image changed
  */
-int iqs5xx_registers_init (const struct device *dev, const struct iqs5xx_reg_config *config) {
+static bool iqs5xx_image_put_field(uint8_t *image, const struct iqs5xx_reg_field *field,
+                                   const struct iqs5xx_reg_config *config) {
+    const uint8_t *src = (const uint8_t *)config + field->offset;
+    uint8_t *dst = &image[field->addr - IQS5XX_REG_DUMP_START_ADDRESS];
+    uint8_t value[2];
+
+    if (field->size == 2) {
+        uint16_t v;
+        memcpy(&v, src, sizeof(v));
+        sys_put_be16(v, value);
+    } else {
+        value[0] = *src;
+    }
+
+    if (memcmp(dst, value, field->size) == 0) {
+        return false;
+    }
+
+    memcpy(dst, value, field->size);
+    return true;
+}
+
+// Longest wait for a communication window, several refresh periods at the
+// slowest low power rate
+#define IQS5XX_READY_TIMEOUT_MS 200
+
+/**
+ * @brief Waits for the data ready pin, i.e. an open communication window
+ *
+ * The data ready interrupt wakes the caller and leaves the window to it
+ * rather than to a frame fetch. Poll mode has no interrupt, the transaction
+ * that follows is held by the chip (clock stretching) until its next window.
+ */
+static int iqs5xx_wait_ready(struct iqs5xx_data *data) {
+#ifdef CONFIG_IQS5XX_POLL
+    return 0;
+#else
+    const struct iqs5xx_config *conf = data->dev->config;
+    int ret = 0;
+
+    k_sem_reset(&data->ready_sem);
+    atomic_set(&data->ready_wait, 1);
+
+    // The trigger is stopped during bring-up and suspend, take the edge anyway
+    if (!data->trigger_enabled) {
+        gpio_pin_interrupt_configure_dt(&conf->dr, GPIO_INT_EDGE_TO_ACTIVE);
+    }
+
+    if (gpio_pin_get_dt(&conf->dr) <= 0 &&
+        k_sem_take(&data->ready_sem, K_MSEC(IQS5XX_READY_TIMEOUT_MS)) != 0) {
+        ret = -ETIMEDOUT;
+    }
+
+    if (!data->trigger_enabled) {
+        gpio_pin_interrupt_configure_dt(&conf->dr, GPIO_INT_DISABLE);
+    }
+    atomic_set(&data->ready_wait, 0);
+
+    return ret;
+#endif
+}
+
+/**
+ * @brief Whether the register image last written has event mode enabled. RDY
+ * then stays low without activity, and the chip holds a transaction started
+ * by the host (clock stretching) until its next communication window.
+ */
+static bool iqs5xx_image_event_mode(const struct iqs5xx_data *data) {
+    return data->reg_image[SystemConfig1_adr - IQS5XX_REG_DUMP_START_ADDRESS] & EVENT_MODE;
+}
+
+/**
+ * @brief Writes the config fields that differ from the register image, as merged spans
+ */
+static int iqs5xx_write_image_diff(const struct device *dev, const struct iqs5xx_reg_config *config) {
     struct iqs5xx_data *data = dev->data;
-    const struct iqs5xx_config *conf = dev->config;
+    int err = 0;
+    int span_start = -1;
+    int span_end = -1;
+
+    for (int i = 0; i < ARRAY_SIZE(iqs5xx_config_fields); i++) {
+        const struct iqs5xx_reg_field *field = &iqs5xx_config_fields[i];
+
+        if (!iqs5xx_image_put_field(data->reg_image, field, config)) {
+            continue;
+        }
 
-    k_mutex_lock(&data->i2c_mutex, K_MSEC(5000));
+        const int start = field->addr - IQS5XX_REG_DUMP_START_ADDRESS;
+        const int end = start + field->size;
 
-    // Wait for dataready
-    int timeout = 0;
-    while(!gpio_pin_get_dt(&conf->dr) && timeout < 1000) {
-        k_usleep(200);
-        timeout++;
+        if (span_start >= 0 && start <= span_end + IQS5XX_SPAN_MERGE_GAP) {
+            span_end = MAX(span_end, end);
+            continue;
+        }
+
+        if (span_start >= 0) {
+            err |= iqs5xx_write(dev, IQS5XX_REG_DUMP_START_ADDRESS + span_start,
+                                &data->reg_image[span_start], span_end - span_start);
+        }
+        span_start = start;
+        span_end = end;
     }
 
-    if (timeout >= 1000) {
-        k_mutex_unlock(&data->i2c_mutex);
-        return -ETIMEDOUT;
+    if (span_start >= 0) {
+        err |= iqs5xx_write(dev, IQS5XX_REG_DUMP_START_ADDRESS + span_start,
+                            &data->reg_image[span_start], span_end - span_start);
     }
 
-    // Reset device
+    return err;
+}
+
+/**
+ * @brief Resets the device through SystemControl1
+ */
+static int iqs5xx_soft_reset(const struct device *dev) {
     uint8_t buf = RESET_TP;
     int ret = iqs5xx_write(dev, SystemControl1_adr, &buf, 1);
+
+    iqs5xx_end_window(dev);
+    return ret;
+}
+
+/**
+ * @brief Writes the whole register image to a device that just reset
+ */
+static int iqs5xx_write_image_full(const struct device *dev, const struct iqs5xx_reg_config *config) {
+    struct iqs5xx_data *data = dev->data;
+    uint8_t buf;
+    int ret;
+
+    // Register dump with the config fields in place
+    memcpy(data->reg_image, _iqs5xx_regdump, IQS5XX_REG_DUMP_SIZE);
+    for (int i = 0; i < ARRAY_SIZE(iqs5xx_config_fields); i++) {
+        iqs5xx_image_put_field(data->reg_image, &iqs5xx_config_fields[i], config);
+    }
+
+    // Write register dump and configuration in one transaction
+    ret = iqs5xx_write(dev, IQS5XX_REG_DUMP_START_ADDRESS, data->reg_image, IQS5XX_REG_DUMP_SIZE);
     if (ret < 0) {
-        k_mutex_unlock(&data->i2c_mutex);
         return ret;
     }
 
-    iqs5xx_write(dev, END_WINDOW, 0, 1);
-    k_msleep(10);
+    // Acknowledge the reset, SHOW_RESET then tells whether the device lost the image
+    buf = ACK_RESET;
+    return iqs5xx_write(dev, SystemControl0_adr, &buf, 1);
+}
 
-    // Wait for ready after reset
-    timeout = 0;
-    while(!gpio_pin_get_dt(&conf->dr) && timeout < 1000) {
-        k_usleep(200);
-        timeout++;
-    }
+/**
+ * @brief Mirrors the programmed refresh rates into the poll periods
+ */
+static inline void iqs5xx_update_poll_rates(struct iqs5xx_data *data) {
+#ifdef CONFIG_IQS5XX_POLL
+    data->active_rr = data->reg_config.activeRefreshRate;
+    data->idle_rr = data->reg_config.idleRefreshRate;
+#endif
+}
 
-    if (timeout >= 1000) {
-        k_mutex_unlock(&data->i2c_mutex);
-        return -ETIMEDOUT;
-    }
+/**
+ * @brief Sets registers to initial values
+ *
+ * If the device has not reset since the register image was last written,
+ * only the config fields that changed are written, without a reset. A
+ * device that lost its image, or one being brought up, gets the config
+ * from the bring-up state machine.
+ */
+int iqs5xx_registers_init (const struct device *dev, const struct iqs5xx_reg_config *config) {
+    struct iqs5xx_data *data = dev->data;
 
-    // Write register dump
-    iqs_regdump_err = iqs5xx_reg_dump(dev);
-    if (iqs_regdump_err < 0) {
-        k_mutex_unlock(&data->i2c_mutex);
-        return iqs_regdump_err;
+    int ret = iqs5xx_bus_lock(data, K_MSEC(5000));
+    if (ret < 0) {
+        return ret;
     }
 
-    // Wait for ready after regdump
-    timeout = 0;
-    while(!gpio_pin_get_dt(&conf->dr) && timeout < 1000) {
-        k_usleep(200);
-        timeout++;
+    // Bring-up writes data->reg_config once the chip is back
+    if (data->recovery_state != IQS5XX_RECOVERY_IDLE || !data->reg_image_valid) {
+        if (config != &data->reg_config) {
+            data->reg_config = *config;
+        }
+        iqs5xx_bus_unlock(data);
+        return 0;
     }
 
-    if (timeout >= 1000) {
-        k_mutex_unlock(&data->i2c_mutex);
-        return -ETIMEDOUT;
+    // In event mode RDY stays low while the pad is idle, write right away and
+    // let the chip hold the transaction until its next window
+    if (!iqs5xx_image_event_mode(data)) {
+        ret = iqs5xx_wait_ready(data);
+        if (ret < 0) {
+            iqs5xx_bus_unlock(data);
+            return ret;
+        }
     }
 
-    int err = 0;
-    uint8_t wbuff[16];
+    uint8_t sys_info0;
+    ret = iqs5xx_seq_read(dev, SystemInfo0_adr, &sys_info0, 1);
+    if (ret == 0 && (sys_info0 & SHOW_RESET)) {
+        // The device reset on its own, bring it up again with this config
+        if (config != &data->reg_config) {
+            data->reg_config = *config;
+        }
+        data->reg_image_valid = false;
+        iqs5xx_end_window(dev);
+        iqs5xx_bus_unlock(data);
 
-    // Set active refresh rate
-    *((uint16_t*)wbuff) = SWPEND16(config->activeRefreshRate);
-    ret = iqs5xx_write(dev, ActiveRR_adr, wbuff, 2);
-    if (ret < 0) {
-        err |= ret;
+        iqs5xx_recovery_start(data);
+        return 0;
     }
 
-    // Set idle refresh rate
-    *((uint16_t*)wbuff) = SWPEND16(config->idleRefreshRate);
-    ret = iqs5xx_write(dev, IdleRR_adr, wbuff, 2);
-    if (ret < 0) {
-        err |= ret;
+    if (ret == 0) {
+        ret = iqs5xx_write_image_diff(dev, config);
     }
 
-    // Set single finger gestures
-    ret = iqs5xx_write(dev, SFGestureEnable_adr, &config->singleFingerGestureMask, 1);
-    if (ret < 0) {
-        err |= ret;
+    if (ret == 0 && config != &data->reg_config) {
+        data->reg_config = *config;
     }
 
-    // Set multi finger gestures
-    ret = iqs5xx_write(dev, MFGestureEnable_adr, &config->multiFingerGestureMask, 1);
-    if (ret < 0) {
-        err |= ret;
-    }
+    // Terminate transaction
+    iqs5xx_end_window(dev);
 
-    // Set tap time
-    *((uint16_t*)wbuff) = SWPEND16(config->tapTime);
-    ret = iqs5xx_write(dev, TapTime_adr, wbuff, 2);
-    if (ret < 0) {
-        err |= ret;
-    }
+    iqs5xx_update_poll_rates(data);
+    iqs5xx_bus_unlock(data);
 
-    // Set tap distance
-    *((uint16_t*)wbuff) = SWPEND16(config->tapDistance);
-    ret = iqs5xx_write(dev, TapDistance_adr, wbuff, 2);
-    if (ret < 0) {
-        err |= ret;
+    return ret;
+}
+
+int iqs5xx_get_config(const struct device *dev, struct iqs5xx_reg_config *config) {
+    const struct iqs5xx_data *data = dev->data;
+
+    // Applied, or to be applied by the bring-up in progress
+    *config = data->reg_config;
+    return 0;
+}
+
+int iqs5xx_set_refresh_rate(const struct device *dev, uint16_t active_ms, uint16_t idle_ms) {
+    if (active_ms == 0 || idle_ms == 0) {
+        return -EINVAL;
     }
 
-    // Set touch multiplier
-    ret = iqs5xx_write(dev, GlobalTouchSet_adr, &config->touchMultiplier, 1);
-    if (ret < 0) {
-        err |= ret;
+    struct iqs5xx_reg_config config;
+    iqs5xx_get_config(dev, &config);
+    config.activeRefreshRate = active_ms;
+    config.idleRefreshRate = idle_ms;
+
+    return iqs5xx_registers_init(dev, &config);
+}
+
+int iqs5xx_set_filter(const struct device *dev, uint8_t settings, uint8_t bottom_beta,
+                      uint8_t lower_speed, uint16_t upper_speed) {
+    struct iqs5xx_reg_config config;
+    iqs5xx_get_config(dev, &config);
+    config.filterSettings = settings;
+    config.filterDynBottomBeta = bottom_beta;
+    config.filterDynLowerSpeed = lower_speed;
+    config.filterDynUpperSpeed = upper_speed;
+
+    return iqs5xx_registers_init(dev, &config);
+}
+
+int iqs5xx_restore_config(const struct device *dev) {
+    const struct iqs5xx_config *conf = dev->config;
+
+    return iqs5xx_registers_init(dev, &conf->reg_config);
+}
+
+int iqs5xx_get_error_stats(const struct device *dev, struct iqs5xx_error_stats *stats) {
+    const struct iqs5xx_data *data = dev->data;
+
+    *stats = data->errors;
+    return 0;
+}
+
+int iqs5xx_get_stats(const struct device *dev, struct iqs5xx_stats *stats) {
+    const struct iqs5xx_data *data = dev->data;
+
+    *stats = (struct iqs5xx_stats){
+        .frames = data->frames_fetched,
+        .unchanged = data->frames_unchanged,
+        .frame_overruns = data->frame_overruns,
+        .rr_missed = data->rr_missed,
+        .ati_errors = data->ati_errors,
+        .reati_events = data->reati_events,
+#ifdef CONFIG_IQS5XX_PALM_FILTER
+        .palm_frames = data->palm_frames,
+#endif
+#ifdef CONFIG_IQS5XX_I2C_ASYNC
+        .async_rereads = data->async_rereads,
+#endif
+        .errors = data->errors,
+    };
+
+    if (data->bus_reads > 0) {
+        stats->bus_time_avg_us = k_cyc_to_us_floor32((uint32_t)(data->bus_cycles / data->bus_reads));
     }
+    return 0;
+}
 
-    // Set debounce settings
-    ret = iqs5xx_write(dev, ProxDb_adr, &config->debounce, 1);
-    if (ret < 0) {
-        err |= ret;
+void iqs5xx_reset_stats(const struct device *dev) {
+    struct iqs5xx_data *data = dev->data;
+
+    data->frames_fetched = 0;
+    data->frames_unchanged = 0;
+    data->frame_overruns = 0;
+    data->rr_missed = 0;
+    data->ati_errors = 0;
+    data->reati_events = 0;
+    data->bus_cycles = 0;
+    data->bus_reads = 0;
+#ifdef CONFIG_IQS5XX_PALM_FILTER
+    data->palm_frames = 0;
+#endif
+#ifdef CONFIG_IQS5XX_I2C_ASYNC
+    data->async_rereads = 0;
+#endif
+    data->errors = (struct iqs5xx_error_stats){0};
+}
+
+int iqs5xx_read_registers(const struct device *dev, uint16_t addr, uint8_t *buf, uint8_t len) {
+    struct iqs5xx_data *data = dev->data;
+
+    // The bring-up state machine owns the chip until the trigger runs again
+    if (data->recovery_state != IQS5XX_RECOVERY_IDLE) {
+        return -EBUSY;
     }
 
-    ret = iqs5xx_write(dev, TouchSnapDb_adr, &config->debounce, 1);
+    int ret = iqs5xx_bus_lock(data, K_MSEC(1000));
     if (ret < 0) {
-        err |= ret;
+        return ret;
     }
 
-    // Set noise reduction
-    wbuff[0] = 0;
-    ret = iqs5xx_write(dev, HardwareSettingsA_adr, wbuff, 1);
-    if (ret < 0) {
-        err |= ret;
+    // Same as iqs5xx_registers_init, outside event mode open the next window first
+    if (!iqs5xx_image_event_mode(data)) {
+        ret = iqs5xx_wait_ready(data);
+        if (ret < 0) {
+            iqs5xx_bus_unlock(data);
+            return ret;
+        }
     }
 
-    // Set i2c timeout
-    ret = iqs5xx_write(dev, I2CTimeout_adr, &config->i2cTimeout, 1);
-    if (ret < 0) {
-        err |= ret;
+    ret = iqs5xx_seq_read(dev, addr, buf, len);
+    iqs5xx_end_window(dev);
+
+    iqs5xx_bus_unlock(data);
+    return ret;
+}
+
+// Reset pulse width, and time for the chip to boot once the pin is released
+#define IQS5XX_RESET_HOLD_MS    1
+#define IQS5XX_RESET_BOOT_MS    10
+
+/**
+ * @brief Writes the whole register configuration in the first window after a
+ * reset and restarts the data ready trigger. Shared by init and recovery.
+ *
+ * @return 0, -EBUSY while a thread holds the bus, or the write error
+ */
+static int iqs5xx_bring_up(struct iqs5xx_data *data) {
+    if (iqs5xx_bus_lock(data, K_NO_WAIT) != 0) {
+        return -EBUSY;
     }
 
-    // Set filter settings
-    ret = iqs5xx_write(dev, FilterSettings0_adr, &config->filterSettings, 1);
-    if (ret < 0) {
-        err |= ret;
+    // Runtime changes (refresh rates, filters) survive a recovery
+    int ret = iqs5xx_write_image_full(data->dev, &data->reg_config);
+    iqs5xx_end_window(data->dev);
+
+    data->reg_image_valid = (ret == 0);
+    if (ret == 0) {
+        iqs5xx_update_poll_rates(data);
+        data->recovery_state = IQS5XX_RECOVERY_IDLE;
+        iqs5xx_trigger_enable(data, true);
     }
 
-    ret = iqs5xx_write(dev, DynamicBottomBeta_adr, &config->filterDynBottomBeta, 1);
-    if (ret < 0) {
-        err |= ret;
+    iqs5xx_bus_unlock(data);
+    return ret;
+}
+
+/**
+ * @brief Waits for the chip to boot, then for its first communication window
+ */
+static void iqs5xx_recovery_wait_ready(struct iqs5xx_data *data) {
+    data->recovery_deadline = k_uptime_get() + IQS5XX_RESET_BOOT_MS + IQS5XX_READY_TIMEOUT_MS;
+    data->recovery_state = IQS5XX_RECOVERY_WAIT_READY;
+    iqs5xx_schedule_recovery(data, K_MSEC(IQS5XX_RESET_BOOT_MS));
+}
+
+/**
+ * @brief Retry delay after the given number of failed attempts, doubling up to the maximum
+ */
+static k_timeout_t iqs5xx_recovery_backoff(uint8_t attempts) {
+    uint32_t delay = CONFIG_IQS5XX_RECOVERY_BACKOFF_MIN_MS;
+
+    for (uint8_t i = 1; i < attempts && delay < CONFIG_IQS5XX_RECOVERY_BACKOFF_MAX_MS; i++) {
+        delay *= 2;
     }
 
-    ret = iqs5xx_write(dev, DynamicLowerSpeed_adr, &config->filterDynLowerSpeed, 1);
-    if (ret < 0) {
-        err |= ret;
+    return K_MSEC(MIN(delay, CONFIG_IQS5XX_RECOVERY_BACKOFF_MAX_MS));
+}
+
+/**
+ * @brief Bring-up state machine. Each step returns to the workqueue and
+ * reschedules itself for the next one instead of sleeping.
+ */
+static void iqs5xx_recovery_work_cb(struct k_work *work) {
+    struct k_work_delayable *dwork = k_work_delayable_from_work(work);
+    struct iqs5xx_data *data = CONTAINER_OF(dwork, struct iqs5xx_data, recovery_work);
+    const struct iqs5xx_config *config = data->dev->config;
+
+    int ret = 0;
+
+    switch (data->recovery_state) {
+    case IQS5XX_RECOVERY_IDLE:
+        return;
+
+    case IQS5XX_RECOVERY_RESET:
+        if (config->reset.port != NULL) {
+            gpio_pin_set_dt(&config->reset, 1);
+            data->errors.hard_resets++;
+
+            data->recovery_state = IQS5XX_RECOVERY_RELEASE;
+            iqs5xx_schedule_recovery(data, K_MSEC(IQS5XX_RESET_HOLD_MS));
+            return;
+        }
+
+        // Without a reset pin, reset through SystemControl1. This also gets a
+        // chip left in event mode out of it, so its windows show on RDY again.
+        if (iqs5xx_bus_lock(data, K_NO_WAIT) != 0) {
+            iqs5xx_schedule_recovery(data, K_MSEC(1));
+            return;
+        }
+        ret = iqs5xx_soft_reset(data->dev);
+        iqs5xx_bus_unlock(data);
+        if (ret < 0) {
+            break;
+        }
+
+        iqs5xx_recovery_wait_ready(data);
+        return;
+
+    case IQS5XX_RECOVERY_RELEASE:
+        gpio_pin_set_dt(&config->reset, 0);
+
+        iqs5xx_recovery_wait_ready(data);
+        return;
+
+    case IQS5XX_RECOVERY_WAIT_READY:
+#ifndef CONFIG_IQS5XX_POLL
+        // The data ready ISR wakes the state machine, the trigger itself stays off
+        gpio_pin_interrupt_configure_dt(&config->dr, GPIO_INT_EDGE_TO_ACTIVE);
+#endif
+        if (gpio_pin_get_dt(&config->dr) <= 0) {
+            const int64_t remaining = data->recovery_deadline - k_uptime_get();
+
+            if (remaining > 0) {
+                // Poll mode has no interrupt, sample the pin each millisecond
+                iqs5xx_schedule_recovery(data, IS_ENABLED(CONFIG_IQS5XX_POLL) ?
+                                               K_MSEC(1) : K_MSEC(remaining));
+                return;
+            }
+            ret = -ETIMEDOUT;
+            break;
+        }
+
+        data->recovery_state = IQS5XX_RECOVERY_CONFIGURE;
+        __fallthrough;
+
+    case IQS5XX_RECOVERY_CONFIGURE:
+        ret = iqs5xx_bring_up(data);
+        if (ret == -EBUSY) {
+            iqs5xx_schedule_recovery(data, K_MSEC(1));
+            return;
+        }
+        if (ret == 0) {
+            data->recovery_attempts = 0;
+            return;
+        }
+        break;
     }
 
-    *((uint16_t*)wbuff) = SWPEND16(config->filterDynUpperSpeed);
-    ret = iqs5xx_write(dev, DynamicUpperSpeed_adr, wbuff, 2);
-    if (ret < 0) {
-        err |= ret;
+    // Stops the interrupt taken for the wait
+    iqs5xx_trigger_enable(data, false);
+
+    data->errors.failed_attempts++;
+    if (data->recovery_attempts < UINT8_MAX) {
+        data->recovery_attempts++;
     }
 
-    // Set initial scroll distance
-    *((uint16_t*)wbuff) = SWPEND16(config->initScrollDistance);
-    ret = iqs5xx_write(dev, ScrollInitDistance_adr, wbuff, 2);
+    data->recovery_state = IQS5XX_RECOVERY_RESET;
+    iqs5xx_schedule_recovery(data, iqs5xx_recovery_backoff(data->recovery_attempts));
+}
+
+#ifdef CONFIG_PM_DEVICE
+/**
+ * @brief Puts the chip in or out of suspend (SystemControl1)
+ */
+static int iqs5xx_set_suspend(const struct device *dev, bool suspend) {
+    struct iqs5xx_data *data = dev->data;
+    uint8_t ctrl = suspend ? SUSPEND : 0;
+
+    // Host initiated, the chip holds the transaction until its next window
+    int ret = iqs5xx_bus_lock(data, K_MSEC(1000));
     if (ret < 0) {
-        err |= ret;
+        return ret;
     }
 
-    // Terminate transaction
-    iqs5xx_write(dev, END_WINDOW, 0, 1);
+    ret = iqs5xx_write(dev, SystemControl1_adr, &ctrl, 1);
+    iqs5xx_end_window(dev);
+    iqs5xx_bus_unlock(data);
 
-    k_mutex_unlock(&data->i2c_mutex);
+    return ret;
+}
 
-    if (err == 0) {
-        return 0;
-    } else {
-        return err;
+static int iqs5xx_pm_action(const struct device *dev, enum pm_device_action action) {
+    struct iqs5xx_data *data = dev->data;
+    int ret;
+
+    switch (action) {
+    case PM_DEVICE_ACTION_SUSPEND:
+        iqs5xx_trigger_enable(data, false);
+        k_work_cancel(&data->work);
+        k_work_cancel_delayable(&data->recovery_work);
+
+        // Not talking to the chip anyway, bring-up starts over on resume
+        if (data->recovery_state != IQS5XX_RECOVERY_IDLE) {
+            return 0;
+        }
+
+        ret = iqs5xx_set_suspend(dev, true);
+        if (ret < 0) {
+            iqs5xx_trigger_enable(data, true);
+        }
+        return ret;
+
+    case PM_DEVICE_ACTION_RESUME:
+        if (data->recovery_state != IQS5XX_RECOVERY_IDLE) {
+            iqs5xx_recovery_start(data);
+            return 0;
+        }
+
+        ret = iqs5xx_set_suspend(dev, false);
+        if (ret < 0) {
+            return ret;
+        }
+
+        // Only rewrites what changed, or the full image if the chip reset meanwhile
+        if (data->reg_image_valid) {
+            ret = iqs5xx_registers_init(dev, &data->reg_config);
+        }
+
+        iqs5xx_trigger_enable(data, true);
+        return ret;
+
+    default:
+        return -ENOTSUP;
     }
 }
+#endif
 
 static int iqs5xx_init(const struct device *dev) {
     struct iqs5xx_data *data = dev->data;
     const struct iqs5xx_config *config = dev->config;
 
     data->dev = dev;
-    data->i2c = DEVICE_DT_GET(DT_BUS(DT_DRV_INST(0)));
 
-    if (!data->i2c) {
+    if (!i2c_is_ready_dt(&config->i2c)) {
         return -ENODEV;
     }
 
-    // RUNTIME DEVICETREE DEBUG
-    // Check if GPIO was properly initialized by GPIO_DT_SPEC_GET_OR
     if (!device_is_ready(config->dr.port)) {
-        // Check if it's an empty GPIO spec (fallback case)
-        if (config->dr.port == NULL) {
-            return -ENODEV;
-        } else {
-            return -ENODEV;
-        }
+        return -ENODEV;
     }
 
+#ifdef CONFIG_IQS5XX_I2C_ASYNC
+    k_sem_init(&data->bus_sem, 1, 1);
+#else
     k_mutex_init(&data->i2c_mutex);
+#endif
+#ifndef CONFIG_IQS5XX_POLL
+    k_sem_init(&data->ready_sem, 0, 1);
+#endif
     k_work_init(&data->work, iqs5xx_work_cb);
+    k_work_init(&data->process_work, iqs5xx_process_work_cb);
+    k_work_init_delayable(&data->recovery_work, iqs5xx_recovery_work_cb);
+
+#ifdef CONFIG_IQS5XX_TRIGGER_OWN_THREAD
+    const struct k_work_queue_config workq_config = {
+        .name = dev->name,
+    };
+
+    k_work_queue_init(&data->workq);
+    k_work_queue_start(&data->workq, data->thread_stack,
+                       K_KERNEL_STACK_SIZEOF(data->thread_stack),
+                       K_PRIO_PREEMPT(CONFIG_IQS5XX_THREAD_PRIORITY), &workq_config);
+#endif
 
     // Configure data ready pin
     int ret = gpio_pin_configure_dt(&config->dr, GPIO_INPUT);
@@ -422,64 +1422,61 @@ static int iqs5xx_init(const struct device *dev) {
         return ret;
     }
 
-    // Initialize interrupt callback
-    gpio_init_callback(&data->dr_cb, iqs5xx_gpio_cb, BIT(config->dr.pin));
+    // Reset pin is optional, keep the chip running until recovery pulses it
+    if (config->reset.port != NULL) {
+        if (!device_is_ready(config->reset.port)) {
+            return -ENODEV;
+        }
 
-    // Add callback
-    ret = gpio_add_callback(config->dr.port, &data->dr_cb);
-    if (ret < 0) {
-        return ret;
+        ret = gpio_pin_configure_dt(&config->reset, GPIO_OUTPUT_INACTIVE);
+        if (ret < 0) {
+            return ret;
+        }
     }
 
-    // Configure data ready interrupt
-    ret = gpio_pin_interrupt_configure_dt(&config->dr, GPIO_INT_EDGE_TO_ACTIVE);
-    if (ret < 0) {
-        return ret;
-    }
+#ifdef CONFIG_IQS5XX_POLL
+    k_work_init_delayable(&data->poll_work, iqs5xx_poll_work_cb);
+#else
+    // Initialize interrupt callback
+    gpio_init_callback(&data->dr_cb, iqs5xx_gpio_cb, BIT(config->dr.pin));
 
-    // Test I2C communication with a simple read
-    uint8_t test_buf[2];
-    ret = iqs5xx_seq_read(dev, ProductNumber_adr, test_buf, 2);
+    // Add callback, the interrupt is enabled once the registers are programmed
+    ret = gpio_add_callback(config->dr.port, &data->dr_cb);
     if (ret < 0) {
-        return 0;
-    } else {
-        return 0;
-    }
-
-    // Initialize device registers
-    struct iqs5xx_reg_config iqs5xx_registers = iqs5xx_reg_config_default();
-    ret = iqs5xx_registers_init(dev, &iqs5xx_registers);
-    if(ret) {
         return ret;
     }
+#endif
 
-    // Final test - try to read some data
-    ret = iqs5xx_sample_fetch(dev);
-    if (ret < 0) {
-        return 0;
-    } else {
-        return 0;
-    }
+    // Program the registers from the workqueue, through the same path as
+    // error recovery, so an unresponsive chip is retried instead of stalling boot
+    data->reg_config = config->reg_config;
+    iqs5xx_recovery_start(data);
 
     return 0;
 }
 
-// Device instance data
-static struct iqs5xx_data iqs5xx_data_0 = {
-    .data_ready_handler = NULL
-};
-
-// Device configuration from devicetree - SAFE VERSION WITH BOUNDS CHECK
-static const struct iqs5xx_config iqs5xx_config_0 = {
-    .dr = GPIO_DT_SPEC_GET_OR(DT_DRV_INST(0), dr_gpios, {}),
-    .invert_x = DT_INST_PROP(0, invert_x),
-    .invert_y = DT_INST_PROP(0, invert_y),
-    .rotate_90 = DT_INST_PROP(0, rotate_90),
-    .rotate_180 = DT_INST_PROP(0, rotate_180),
-    .rotate_270 = DT_INST_PROP(0, rotate_270),
-    // Clamp sensitivity to valid uint8_t range to prevent overflow
-    .sensitivity = (uint8_t)MIN(255, MAX(64, DT_INST_PROP_OR(0, sensitivity, 128))),
-};
-
-DEVICE_DT_INST_DEFINE(0, iqs5xx_init, NULL, &iqs5xx_data_0, &iqs5xx_config_0,
-                      POST_KERNEL, CONFIG_APPLICATION_INIT_PRIORITY, NULL);
+// Device instance data and configuration from devicetree
+#define IQS5XX_INIT(n)                                                                          \
+    static struct iqs5xx_data iqs5xx_data_##n = {                                               \
+        .data_ready_handler = NULL                                                              \
+    };                                                                                          \
+                                                                                                \
+    static const struct iqs5xx_config iqs5xx_config_##n = {                                     \
+        .instance = n,                                                                          \
+        .i2c = I2C_DT_SPEC_INST_GET(n),                                                         \
+        .dr = GPIO_DT_SPEC_GET_OR(DT_DRV_INST(n), dr_gpios, {}),                                \
+        .reset = GPIO_DT_SPEC_GET_OR(DT_DRV_INST(n), reset_gpios, {}),                          \
+        IF_ENABLED(CONFIG_IQS5XX_PALM_FILTER, (                                                 \
+            .palm_area_max = DT_INST_PROP_OR(n, palm_area_max, 0),                              \
+            .finger_strength_min = DT_INST_PROP_OR(n, finger_strength_min, 0),                  \
+        ))                                                                                      \
+        .reg_config = IQS5XX_REG_CONFIG_DT(n),                                                  \
+    };                                                                                          \
+                                                                                                \
+    PM_DEVICE_DT_INST_DEFINE(n, iqs5xx_pm_action);                                              \
+                                                                                                \
+    DEVICE_DT_INST_DEFINE(n, iqs5xx_init, PM_DEVICE_DT_INST_GET(n),                             \
+                          &iqs5xx_data_##n, &iqs5xx_config_##n,                                 \
+                          POST_KERNEL, CONFIG_APPLICATION_INIT_PRIORITY, NULL);
+
+DT_INST_FOREACH_STATUS_OKAY(IQS5XX_INIT)
@@ -0,0 +1,203 @@
+#include <zephyr/kernel.h>
+#include <zephyr/init.h>
+#include <zephyr/sys/ring_buffer.h>
+#include <zephyr/sys/util.h>
+#include <string.h>
+#include "iqs5xx.h"
+#include "iqs5xx_capture.h"
+
+#if defined(CONFIG_IQS5XX_CAPTURE_RTT)
+#include <SEGGER_RTT.h>
+#elif defined(CONFIG_IQS5XX_CAPTURE_UART)
+#include <zephyr/drivers/uart.h>
+#endif
+
+// Largest record: tag, 5 byte dt, 4 info bytes, 2 x 3 byte rx/ry, 5 x (3 x 3 + 1) byte fingers
+#define IQS5XX_CAPTURE_RECORD_MAX   (1 + 5 + 4 + 6 + IQS5XX_MAX_FINGERS * 10)
+
+// Instances the tag can address
+#define IQS5XX_CAPTURE_INSTANCES    4
+
+RING_BUF_DECLARE(capture_ring, CONFIG_IQS5XX_CAPTURE_BUFFER_SIZE);
+
+// Producer state, guarded by capture_lock when several trackpads fetch concurrently
+static struct k_spinlock capture_lock;
+static struct {
+    struct iqs5xx_rawdata last;
+    uint32_t last_cycles;
+    bool keyframe_sent;
+} capture_prev[IQS5XX_CAPTURE_INSTANCES];
+static bool capture_resync;
+static uint32_t capture_drops;
+
+static struct k_work_delayable capture_drain_work;
+
+#ifdef CONFIG_IQS5XX_CAPTURE_RTT
+static uint8_t capture_rtt_buf[CONFIG_IQS5XX_CAPTURE_BUFFER_SIZE];
+#endif
+
+#ifdef CONFIG_IQS5XX_CAPTURE_UART
+static const struct device *const capture_uart = DEVICE_DT_GET(DT_CHOSEN(zmk_iqs5xx_capture));
+#endif
+
+static inline uint8_t *capture_put_varint(uint8_t *p, uint32_t v) {
+    while (v >= 0x80) {
+        *p++ = (uint8_t)v | 0x80;
+        v >>= 7;
+    }
+    *p++ = (uint8_t)v;
+    return p;
+}
+
+static inline uint8_t *capture_put_svarint(uint8_t *p, int32_t v) {
+    return capture_put_varint(p, ((uint32_t)v << 1) ^ (uint32_t)(v >> 31));
+}
+
+void iqs5xx_capture_frame(const struct device *dev, const struct iqs5xx_rawdata *frame) {
+    const struct iqs5xx_config *config = dev->config;
+    const uint8_t inst = config->instance % IQS5XX_CAPTURE_INSTANCES;
+    const uint32_t now = k_cycle_get_32();
+    uint8_t record[IQS5XX_CAPTURE_RECORD_MAX];
+
+    k_spinlock_key_t key = k_spin_lock(&capture_lock);
+
+    const bool keyframe = capture_resync || !capture_prev[inst].keyframe_sent;
+    const struct iqs5xx_rawdata *prev = &capture_prev[inst].last;
+    const uint32_t dt_us = keyframe ? 0 : k_cyc_to_us_floor32(now - capture_prev[inst].last_cycles);
+
+    uint8_t tag = MIN(frame->finger_count, IQS5XX_MAX_FINGERS) | (inst << IQS5XX_CAPTURE_TAG_INSTANCE_POS);
+    if (keyframe) {
+        tag |= IQS5XX_CAPTURE_TAG_KEYFRAME | IQS5XX_CAPTURE_TAG_GESTURES | IQS5XX_CAPTURE_TAG_SYSINFO;
+    }
+    if (frame->gestures0 != 0 || frame->gestures1 != 0) {
+        tag |= IQS5XX_CAPTURE_TAG_GESTURES;
+    }
+    if (frame->system_info0 != prev->system_info0 || frame->system_info1 != prev->system_info1) {
+        tag |= IQS5XX_CAPTURE_TAG_SYSINFO;
+    }
+
+    uint8_t *p = record;
+    *p++ = tag;
+    p = capture_put_varint(p, dt_us);
+    if (tag & IQS5XX_CAPTURE_TAG_GESTURES) {
+        *p++ = frame->gestures0;
+        *p++ = frame->gestures1;
+    }
+    if (tag & IQS5XX_CAPTURE_TAG_SYSINFO) {
+        *p++ = frame->system_info0;
+        *p++ = frame->system_info1;
+    }
+    p = capture_put_svarint(p, frame->rx);
+    p = capture_put_svarint(p, frame->ry);
+
+    for (int i = 0; i < (tag & IQS5XX_CAPTURE_TAG_FINGERS); i++) {
+        const struct iqs5xx_finger *f = &frame->fingers[i];
+        const struct iqs5xx_finger *pf = &prev->fingers[i];
+
+        if (keyframe) {
+            p = capture_put_svarint(p, f->ax);
+            p = capture_put_svarint(p, f->ay);
+            p = capture_put_svarint(p, f->strength);
+        } else {
+            p = capture_put_svarint(p, (int32_t)f->ax - pf->ax);
+            p = capture_put_svarint(p, (int32_t)f->ay - pf->ay);
+            p = capture_put_svarint(p, (int32_t)f->strength - pf->strength);
+        }
+        *p++ = (uint8_t)f->area;
+    }
+
+    const uint32_t len = p - record;
+    if (ring_buf_space_get(&capture_ring) < len) {
+        // Deltas are lost with this record, resync every instance with a keyframe
+        capture_drops++;
+        capture_resync = true;
+        for (int i = 0; i < IQS5XX_CAPTURE_INSTANCES; i++) {
+            capture_prev[i].keyframe_sent = false;
+        }
+    } else {
+        ring_buf_put(&capture_ring, record, len);
+        capture_prev[inst].last = *frame;
+        capture_prev[inst].last_cycles = now;
+        capture_prev[inst].keyframe_sent = true;
+        capture_resync = false;
+    }
+
+    k_spin_unlock(&capture_lock, key);
+
+    // No effect while a drain is already pending
+    k_work_schedule(&capture_drain_work, K_MSEC(CONFIG_IQS5XX_CAPTURE_DRAIN_MS));
+}
+
+#ifdef CONFIG_IQS5XX_CAPTURE_UART
+// Refills the TX FIFO from the ring as it empties, stops once the ring is drained
+static void capture_uart_isr(const struct device *dev, void *user_data) {
+    uint8_t *chunk;
+
+    if (!uart_irq_update(dev) || !uart_irq_tx_ready(dev)) {
+        return;
+    }
+
+    k_spinlock_key_t key = k_spin_lock(&capture_lock);
+
+    const uint32_t len = ring_buf_get_claim(&capture_ring, &chunk, CONFIG_IQS5XX_CAPTURE_BUFFER_SIZE);
+    if (len == 0) {
+        uart_irq_tx_disable(dev);
+    } else {
+        const int sent = uart_fifo_fill(dev, chunk, len);
+        ring_buf_get_finish(&capture_ring, MAX(sent, 0));
+    }
+
+    k_spin_unlock(&capture_lock, key);
+}
+#endif
+
+// Moves captured records to the backend, outside of the fetch path and
+// without holding the system workqueue for longer than a short copy
+static void capture_drain_work_cb(struct k_work *work) {
+#if defined(CONFIG_IQS5XX_CAPTURE_RTT)
+    uint32_t budget = CONFIG_IQS5XX_CAPTURE_DRAIN_MAX;
+    uint8_t *chunk;
+    uint32_t len;
+
+    while (budget > 0 && (len = ring_buf_get_claim(&capture_ring, &chunk, budget)) > 0) {
+        const uint32_t sent = SEGGER_RTT_Write(CONFIG_IQS5XX_CAPTURE_RTT_CHANNEL, chunk, len);
+
+        ring_buf_get_finish(&capture_ring, sent);
+        budget -= sent;
+
+        if (sent < len) {
+            // Host is not reading fast enough, try again later
+            break;
+        }
+    }
+
+    if (!ring_buf_is_empty(&capture_ring)) {
+        k_work_schedule(&capture_drain_work, K_MSEC(CONFIG_IQS5XX_CAPTURE_DRAIN_MS));
+    }
+#else
+    // The TX interrupt sends the ring one FIFO load at a time
+    uart_irq_tx_enable(capture_uart);
+#endif
+}
+
+static int iqs5xx_capture_init(void) {
+    k_work_init_delayable(&capture_drain_work, capture_drain_work_cb);
+
+#if defined(CONFIG_IQS5XX_CAPTURE_RTT)
+    SEGGER_RTT_ConfigUpBuffer(CONFIG_IQS5XX_CAPTURE_RTT_CHANNEL, "iqs5xx", capture_rtt_buf,
+                              sizeof(capture_rtt_buf), SEGGER_RTT_MODE_NO_BLOCK_TRIM);
+#else
+    if (!device_is_ready(capture_uart)) {
+        return -ENODEV;
+    }
+
+    int ret = uart_irq_callback_user_data_set(capture_uart, capture_uart_isr, NULL);
+    if (ret < 0) {
+        return ret;
+    }
+#endif
+
+    return 0;
+}
+
+SYS_INIT(iqs5xx_capture_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
@@ -0,0 +1,146 @@
+#include <zephyr/kernel.h>
+#include <zephyr/sys/util.h>
+#include <string.h>
+#include "iqs5xx.h"
+#include "iqs5xx_latency.h"
+
+// Marker for a stage that was not reached in a frame
+#define IQS5XX_LAT_NONE     UINT32_MAX
+
+// Sort buffer of iqs5xx_latency_get, kept off the caller's (shell) stack
+static uint32_t latency_samples[CONFIG_IQS5XX_LATENCY_RING_SIZE];
+static K_MUTEX_DEFINE(latency_samples_lock);
+
+static inline struct iqs5xx_latency *iqs5xx_latency_of(const struct device *dev) {
+    struct iqs5xx_data *data = dev->data;
+
+    return &data->latency;
+}
+
+void iqs5xx_latency_mark(const struct device *dev, enum iqs5xx_latency_stage stage) {
+    struct iqs5xx_latency *lat = iqs5xx_latency_of(dev);
+    const uint32_t now = k_cycle_get_32();
+
+    if (stage == IQS5XX_LAT_ISR) {
+        lat->isr_cycles = now;
+        lat->isr_pending = true;
+        return;
+    }
+
+    // Fetch stages run in the fetch work item, the rest while dispatching
+    struct iqs5xx_latency_frame *frame = (stage < IQS5XX_LAT_REPORT) ? &lat->fetch : &lat->dispatch;
+
+    if (stage == IQS5XX_LAT_WORK_START) {
+        // New frame, adopt the interrupt timestamp that triggered it
+        frame->marks = 0;
+        if (lat->isr_pending) {
+            lat->isr_pending = false;
+            frame->cycles[IQS5XX_LAT_ISR] = lat->isr_cycles;
+            frame->marks |= BIT(IQS5XX_LAT_ISR);
+        }
+    } else if (frame->marks & BIT(stage)) {
+        return; // Only the first occurrence counts
+    }
+
+    frame->cycles[stage] = now;
+    frame->marks |= BIT(stage);
+}
+
+void iqs5xx_latency_publish(const struct device *dev, struct iqs5xx_latency_frame *frame) {
+    struct iqs5xx_latency *lat = iqs5xx_latency_of(dev);
+
+    *frame = lat->fetch;
+    lat->fetch.marks = 0;
+}
+
+void iqs5xx_latency_consume(const struct device *dev, const struct iqs5xx_latency_frame *frame) {
+    struct iqs5xx_latency *lat = iqs5xx_latency_of(dev);
+
+    lat->dispatch = *frame;
+}
+
+void iqs5xx_latency_frame_end(const struct device *dev) {
+    struct iqs5xx_latency *lat = iqs5xx_latency_of(dev);
+    struct iqs5xx_latency_frame *frame = &lat->dispatch;
+
+    if (!(frame->marks & BIT(IQS5XX_LAT_WORK_START))) {
+        return;
+    }
+
+    // Frames start at the interrupt, or at the work item when polling
+    const enum iqs5xx_latency_stage origin = (frame->marks & BIT(IQS5XX_LAT_ISR)) ?
+                                             IQS5XX_LAT_ISR : IQS5XX_LAT_WORK_START;
+
+    k_spinlock_key_t key = k_spin_lock(&lat->ring_lock);
+
+    uint32_t *slot = lat->ring[lat->ring_head];
+    for (int i = 0; i < IQS5XX_LAT_STAGE_COUNT; i++) {
+        slot[i] = (frame->marks & BIT(i)) ?
+                  frame->cycles[i] - frame->cycles[origin] : IQS5XX_LAT_NONE;
+    }
+    slot[IQS5XX_LAT_ISR] = (origin == IQS5XX_LAT_ISR) ? 0 : IQS5XX_LAT_NONE;
+
+    lat->ring_head = (lat->ring_head + 1) % CONFIG_IQS5XX_LATENCY_RING_SIZE;
+    lat->ring_count = MIN(lat->ring_count + 1, CONFIG_IQS5XX_LATENCY_RING_SIZE);
+
+    k_spin_unlock(&lat->ring_lock, key);
+
+    frame->marks = 0;
+}
+
+void iqs5xx_latency_get(const struct device *dev, struct iqs5xx_latency_stats stats[IQS5XX_LAT_STAGE_COUNT]) {
+    struct iqs5xx_latency *lat = iqs5xx_latency_of(dev);
+    uint32_t *samples = latency_samples;
+
+    k_mutex_lock(&latency_samples_lock, K_FOREVER);
+
+    for (int stage = 0; stage < IQS5XX_LAT_STAGE_COUNT; stage++) {
+        uint32_t n = 0;
+        uint64_t sum = 0;
+
+        k_spinlock_key_t key = k_spin_lock(&lat->ring_lock);
+        for (uint32_t i = 0; i < lat->ring_count; i++) {
+            if (lat->ring[i][stage] != IQS5XX_LAT_NONE) {
+                samples[n++] = lat->ring[i][stage];
+            }
+        }
+        k_spin_unlock(&lat->ring_lock, key);
+
+        memset(&stats[stage], 0, sizeof(stats[stage]));
+        if (n == 0) {
+            continue;
+        }
+
+        // Insertion sort, the ring is small
+        for (uint32_t i = 1; i < n; i++) {
+            uint32_t v = samples[i];
+            uint32_t j = i;
+            while (j > 0 && samples[j - 1] > v) {
+                samples[j] = samples[j - 1];
+                j--;
+            }
+            samples[j] = v;
+        }
+
+        for (uint32_t i = 0; i < n; i++) {
+            sum += samples[i];
+        }
+
+        stats[stage].count = n;
+        stats[stage].min_us = k_cyc_to_us_floor32(samples[0]);
+        stats[stage].avg_us = k_cyc_to_us_floor32((uint32_t)(sum / n));
+        stats[stage].p99_us = k_cyc_to_us_floor32(samples[(n * 99) / 100]);
+        stats[stage].max_us = k_cyc_to_us_floor32(samples[n - 1]);
+    }
+
+    k_mutex_unlock(&latency_samples_lock);
+}
+
+void iqs5xx_latency_reset(const struct device *dev) {
+    struct iqs5xx_latency *lat = iqs5xx_latency_of(dev);
+
+    k_spinlock_key_t key = k_spin_lock(&lat->ring_lock);
+    lat->ring_head = 0;
+    lat->ring_count = 0;
+    k_spin_unlock(&lat->ring_lock, key);
+}
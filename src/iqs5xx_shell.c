@@ -0,0 +1,309 @@
+#include <zephyr/kernel.h>
+#include <zephyr/shell/shell.h>
+#include <stddef.h>
+#include <string.h>
+#include "iqs5xx.h"
+#include "iqs5xx_latency.h"
+#include "trackpad_stats.h"
+
+#define IQS5XX_SHELL_DEV(node_id) DEVICE_DT_GET(node_id),
+
+// All enabled trackpads
+static const struct device *const iqs5xx_devs[] = {
+    DT_FOREACH_STATUS_OKAY(azoteq_iqs5xx, IQS5XX_SHELL_DEV)
+};
+
+#ifdef CONFIG_IQS5XX_LATENCY_STATS
+static const char *const latency_stage_names[IQS5XX_LAT_STAGE_COUNT] = {
+    [IQS5XX_LAT_ISR] = "isr",
+    [IQS5XX_LAT_WORK_START] = "work start",
+    [IQS5XX_LAT_I2C_DONE] = "i2c done",
+    [IQS5XX_LAT_PARSE_DONE] = "parse done",
+    [IQS5XX_LAT_REPORT] = "report",
+    [IQS5XX_LAT_DISPATCH_DONE] = "dispatch done",
+};
+
+static int cmd_iqs5xx_latency(const struct shell *sh, size_t argc, char **argv) {
+    const bool reset = (argc > 1 && strcmp(argv[1], "reset") == 0);
+
+    for (size_t d = 0; d < ARRAY_SIZE(iqs5xx_devs); d++) {
+        const struct device *dev = iqs5xx_devs[d];
+
+        if (!device_is_ready(dev)) {
+            continue;
+        }
+
+        if (reset) {
+            iqs5xx_latency_reset(dev);
+            continue;
+        }
+
+        struct iqs5xx_latency_stats stats[IQS5XX_LAT_STAGE_COUNT];
+        iqs5xx_latency_get(dev, stats);
+
+        shell_print(sh, "%s", dev->name);
+        shell_print(sh, "%-14s %6s %8s %8s %8s %8s", "since RDY (us)", "n", "min", "avg", "p99", "max");
+        for (int i = 0; i < IQS5XX_LAT_STAGE_COUNT; i++) {
+            shell_print(sh, "%-14s %6u %8u %8u %8u %8u", latency_stage_names[i], stats[i].count,
+                        stats[i].min_us, stats[i].avg_us, stats[i].p99_us, stats[i].max_us);
+        }
+    }
+
+    return 0;
+}
+#endif
+
+static const char *const gestures0_names[] = {
+    "single tap", "press and hold", "swipe -x", "swipe +x", "swipe +y", "swipe -y",
+};
+
+static const char *const gestures1_names[] = {
+    "two finger tap", "scroll", "zoom",
+};
+
+BUILD_ASSERT(ARRAY_SIZE(gestures0_names) == ARRAY_SIZE(((struct gesture_stats *)0)->gestures0) &&
+             ARRAY_SIZE(gestures1_names) == ARRAY_SIZE(((struct gesture_stats *)0)->gestures1));
+
+static void stats_print(const struct shell *sh, const char *name, uint32_t value) {
+    shell_print(sh, "  %-18s %10u", name, value);
+}
+
+static int cmd_iqs5xx_stats(const struct shell *sh, size_t argc, char **argv) {
+    const bool reset = (argc > 1 && strcmp(argv[1], "reset") == 0);
+
+    for (size_t d = 0; d < ARRAY_SIZE(iqs5xx_devs); d++) {
+        const struct device *dev = iqs5xx_devs[d];
+
+        if (!device_is_ready(dev)) {
+            continue;
+        }
+
+        if (reset) {
+            iqs5xx_reset_stats(dev);
+            trackpad_reset_stats(dev);
+            continue;
+        }
+
+        struct iqs5xx_stats stats;
+        iqs5xx_get_stats(dev, &stats);
+
+        shell_print(sh, "%s", dev->name);
+        stats_print(sh, "frames", stats.frames);
+        stats_print(sh, "unchanged", stats.unchanged);
+        stats_print(sh, "ring overruns", stats.frame_overruns);
+        stats_print(sh, "rr missed", stats.rr_missed);
+        stats_print(sh, "ati errors", stats.ati_errors);
+        stats_print(sh, "reati", stats.reati_events);
+#ifdef CONFIG_IQS5XX_PALM_FILTER
+        stats_print(sh, "palm frames", stats.palm_frames);
+#endif
+#ifdef CONFIG_IQS5XX_I2C_ASYNC
+        stats_print(sh, "async rereads", stats.async_rereads);
+#endif
+        stats_print(sh, "bus time avg (us)", stats.bus_time_avg_us);
+        stats_print(sh, "i2c errors", stats.errors.i2c_errors);
+        stats_print(sh, "recoveries", stats.errors.recoveries);
+        stats_print(sh, "failed bring-ups", stats.errors.failed_attempts);
+        stats_print(sh, "hard resets", stats.errors.hard_resets);
+
+        struct trackpad_stats tp;
+        if (trackpad_get_stats(dev, &tp) < 0) {
+            continue;
+        }
+
+        stats_print(sh, "handled", tp.frames);
+        stats_print(sh, "rate limited", tp.rate_limited);
+        stats_print(sh, "typing dropped", tp.typing_dropped);
+        for (int i = 0; i < ARRAY_SIZE(gestures0_names); i++) {
+            stats_print(sh, gestures0_names[i], tp.gestures.gestures0[i]);
+        }
+        for (int i = 0; i < ARRAY_SIZE(gestures1_names); i++) {
+            stats_print(sh, gestures1_names[i], tp.gestures.gestures1[i]);
+        }
+        for (int n = 1; n < ARRAY_SIZE(tp.gestures.sessions); n++) {
+            shell_print(sh, "  %d finger sessions   %10u", n, tp.gestures.sessions[n]);
+        }
+    }
+
+    return 0;
+}
+
+// Register config fields by their devicetree property name, where one exists
+struct iqs5xx_shell_field {
+    const char *name;
+    uint8_t offset;
+    uint8_t size;
+    // Also set by trackpad profiles, see trackpad_profile.h
+    bool profile;
+};
+
+#define IQS5XX_SHELL_FIELD(_name, _member)                                                      \
+    { _name, offsetof(struct iqs5xx_reg_config, _member),                                       \
+      sizeof(((struct iqs5xx_reg_config *)0)->_member), false }
+
+#define IQS5XX_SHELL_PROFILE_FIELD(_name, _member)                                              \
+    { _name, offsetof(struct iqs5xx_reg_config, _member),                                       \
+      sizeof(((struct iqs5xx_reg_config *)0)->_member), true }
+
+static const struct iqs5xx_shell_field reg_fields[] = {
+    IQS5XX_SHELL_PROFILE_FIELD("refresh-rate-active", activeRefreshRate),
+    IQS5XX_SHELL_FIELD("refresh-rate-idle-touch", idleTouchRefreshRate),
+    IQS5XX_SHELL_FIELD("refresh-rate-idle", idleRefreshRate),
+    IQS5XX_SHELL_FIELD("refresh-rate-lp1", lp1RefreshRate),
+    IQS5XX_SHELL_FIELD("refresh-rate-lp2", lp2RefreshRate),
+    IQS5XX_SHELL_FIELD("timeout-active", activeTimeout),
+    IQS5XX_SHELL_FIELD("timeout-idle-touch", idleTouchTimeout),
+    IQS5XX_SHELL_FIELD("timeout-idle", idleTimeout),
+    IQS5XX_SHELL_FIELD("timeout-lp1", lp1Timeout),
+    IQS5XX_SHELL_PROFILE_FIELD("single-finger-gestures", singleFingerGestureMask),
+    IQS5XX_SHELL_PROFILE_FIELD("multi-finger-gestures", multiFingerGestureMask),
+    IQS5XX_SHELL_FIELD("tap-time-ms", tapTime),
+    IQS5XX_SHELL_FIELD("tap-distance", tapDistance),
+    IQS5XX_SHELL_FIELD("touch-multiplier", touchMultiplier),
+    IQS5XX_SHELL_FIELD("debounce", debounce),
+    IQS5XX_SHELL_FIELD("i2c-timeout-ms", i2cTimeout),
+    IQS5XX_SHELL_FIELD("system-config-1", systemConfig1),
+    IQS5XX_SHELL_FIELD("filter-settings", filterSettings),
+    IQS5XX_SHELL_FIELD("filter-dynamic-bottom-beta", filterDynBottomBeta),
+    IQS5XX_SHELL_FIELD("filter-dynamic-lower-speed", filterDynLowerSpeed),
+    IQS5XX_SHELL_FIELD("filter-dynamic-upper-speed", filterDynUpperSpeed),
+    IQS5XX_SHELL_FIELD("hardware-settings-a", hardwareSettingsA),
+    IQS5XX_SHELL_FIELD("xy-config-0", xyConfig0),
+    IQS5XX_SHELL_FIELD("max-touches", maxMultitouches),
+    IQS5XX_SHELL_FIELD("palm-reject-threshold", palmRejectThreshold),
+    IQS5XX_SHELL_FIELD("palm-reject-timeout", palmRejectTimeout),
+    IQS5XX_SHELL_FIELD("scroll-init-distance", initScrollDistance),
+};
+
+static uint16_t reg_field_get(const struct iqs5xx_reg_config *config, const struct iqs5xx_shell_field *field) {
+    const uint8_t *p = (const uint8_t *)config + field->offset;
+    uint16_t value;
+
+    if (field->size == 1) {
+        return *p;
+    }
+    memcpy(&value, p, sizeof(value));
+    return value;
+}
+
+static void reg_field_set(struct iqs5xx_reg_config *config, const struct iqs5xx_shell_field *field,
+                          uint16_t value) {
+    uint8_t *p = (uint8_t *)config + field->offset;
+
+    if (field->size == 1) {
+        *p = value;
+    } else {
+        memcpy(p, &value, sizeof(value));
+    }
+}
+
+// Longest register range dumped with "regs <addr> <len>"
+#define IQS5XX_SHELL_DUMP_MAX   64
+
+static int cmd_iqs5xx_regs(const struct shell *sh, size_t argc, char **argv) {
+    unsigned long addr = 0;
+    unsigned long len = 0;
+
+    if (argc > 1) {
+        int err = 0;
+
+        addr = shell_strtoul(argv[1], 0, &err);
+        len = (argc > 2) ? shell_strtoul(argv[2], 0, &err) : 1;
+        if (err != 0 || addr > UINT16_MAX || len == 0 || len > IQS5XX_SHELL_DUMP_MAX) {
+            shell_error(sh, "usage: regs [<addr> [<len> up to %d]]", IQS5XX_SHELL_DUMP_MAX);
+            return -EINVAL;
+        }
+    }
+
+    for (size_t d = 0; d < ARRAY_SIZE(iqs5xx_devs); d++) {
+        const struct device *dev = iqs5xx_devs[d];
+
+        if (!device_is_ready(dev)) {
+            continue;
+        }
+
+        shell_print(sh, "%s", dev->name);
+
+        if (len > 0) {
+            // Raw registers read from the chip
+            uint8_t buf[IQS5XX_SHELL_DUMP_MAX];
+            int ret = iqs5xx_read_registers(dev, addr, buf, len);
+            if (ret < 0) {
+                shell_error(sh, "read failed (%d)", ret);
+                continue;
+            }
+            shell_print(sh, "0x%04lx:", addr);
+            shell_hexdump(sh, buf, len);
+            continue;
+        }
+
+        // Register configuration last written
+        struct iqs5xx_reg_config config;
+        iqs5xx_get_config(dev, &config);
+        for (int i = 0; i < ARRAY_SIZE(reg_fields); i++) {
+            const uint16_t value = reg_field_get(&config, &reg_fields[i]);
+            shell_print(sh, "  %-28s %5u (0x%02x)", reg_fields[i].name, value, value);
+        }
+    }
+
+    return 0;
+}
+
+static int cmd_iqs5xx_set(const struct shell *sh, size_t argc, char **argv) {
+    const struct iqs5xx_shell_field *field = NULL;
+
+    for (int i = 0; i < ARRAY_SIZE(reg_fields); i++) {
+        if (strcmp(argv[1], reg_fields[i].name) == 0) {
+            field = &reg_fields[i];
+            break;
+        }
+    }
+    if (field == NULL) {
+        shell_error(sh, "unknown field %s, see regs", argv[1]);
+        return -EINVAL;
+    }
+
+    int err = 0;
+    const unsigned long value = shell_strtoul(argv[2], 0, &err);
+    if (err != 0 || value > (field->size == 1 ? UINT8_MAX : UINT16_MAX)) {
+        shell_error(sh, "invalid value %s", argv[2]);
+        return -EINVAL;
+    }
+
+    for (size_t d = 0; d < ARRAY_SIZE(iqs5xx_devs); d++) {
+        const struct device *dev = iqs5xx_devs[d];
+
+        if (!device_is_ready(dev)) {
+            continue;
+        }
+
+        // Only the changed field is written, without a reset
+        struct iqs5xx_reg_config config;
+        iqs5xx_get_config(dev, &config);
+        reg_field_set(&config, field, value);
+
+        int ret = iqs5xx_registers_init(dev, &config);
+        if (ret < 0) {
+            shell_error(sh, "%s: write failed (%d)", dev->name, ret);
+        }
+    }
+
+    if (field->profile) {
+        shell_warn(sh, "%s is also set by profiles, the next profile switch may replace it",
+                   field->name);
+    }
+
+    return 0;
+}
+
+SHELL_STATIC_SUBCMD_SET_CREATE(sub_iqs5xx,
+#ifdef CONFIG_IQS5XX_LATENCY_STATS
+    SHELL_CMD_ARG(latency, NULL, "Pipeline latency per stage [reset]", cmd_iqs5xx_latency, 1, 1),
+#endif
+    SHELL_CMD_ARG(stats, NULL, "Frame, bus, error and gesture counters [reset]", cmd_iqs5xx_stats, 1, 1),
+    SHELL_CMD_ARG(regs, NULL, "Register config, or chip registers [<addr> [<len>]]", cmd_iqs5xx_regs, 1, 2),
+    SHELL_CMD_ARG(set, NULL, "Changes a register config field <field> <value>", cmd_iqs5xx_set, 3, 0),
+    SHELL_SUBCMD_SET_END
+);
+
+SHELL_CMD_REGISTER(iqs5xx, &sub_iqs5xx, "IQS5xx trackpad commands", NULL);
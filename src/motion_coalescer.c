@@ -0,0 +1,58 @@
+#include "gesture_platform.h"
+#include "motion_coalescer.h"
+
+// Frames the report interval may hold back. Hi-res scrolling reports fractional
+// wheel units on every two finger frame, so those always go through.
+static inline bool motion_coalescer_throttled(const struct iqs5xx_rawdata *frame) {
+#ifdef CONFIG_IQS5XX_SCROLL_HIRES
+    return frame->finger_count != 2;
+#else
+    return true;
+#endif
+}
+
+uint8_t motion_coalescer_feed(struct motion_coalescer *mc, const struct iqs5xx_rawdata *frame,
+                              uint8_t last_finger_count, int64_t now, uint16_t interval,
+                              const struct iqs5xx_rawdata *out[MOTION_COALESCER_MAX_OUT]) {
+    // Rate limit ONLY movement events, NEVER gesture events
+    bool has_gesture = (frame->gestures0 != 0) || (frame->gestures1 != 0);
+    bool finger_count_changed = (last_finger_count != frame->finger_count);
+    uint8_t count = 0;
+
+    if (!has_gesture && !finger_count_changed && motion_coalescer_throttled(frame) &&
+        (now - mc->last_report < interval)) {
+        // Motion taken from the tracked contacts spans the held back frames already
+        if (!frame->rel_from_contacts) {
+            mc->pending_rx += frame->rx;
+            mc->pending_ry += frame->ry;
+        }
+        mc->held = *frame;
+        return 0;
+    }
+
+    if (mc->pending_rx != 0 || mc->pending_ry != 0) {
+        if (finger_count_changed && last_finger_count == 1) {
+            // Finger set changed, flush the held back motion as a last single finger
+            // frame. Dispatched like any other, so contacts and sessions stay in step.
+            mc->merged = mc->held;
+            mc->merged.rx = CLAMP(mc->pending_rx, INT16_MIN, INT16_MAX);
+            mc->merged.ry = CLAMP(mc->pending_ry, INT16_MIN, INT16_MAX);
+            out[count++] = &mc->merged;
+        } else if (!finger_count_changed && !frame->rel_from_contacts) {
+            mc->merged = *frame;
+            mc->merged.rx = CLAMP(mc->pending_rx + frame->rx, INT16_MIN, INT16_MAX);
+            mc->merged.ry = CLAMP(mc->pending_ry + frame->ry, INT16_MIN, INT16_MAX);
+            frame = &mc->merged;
+        }
+        // Dropped as well when the frame takes its motion from the tracked contacts,
+        // which moved by the held back motion since the last frame dispatched
+        motion_coalescer_reset(mc);
+    }
+    // Gesture frames don't restart the interval, so they never hold back what follows
+    if (!has_gesture) {
+        mc->last_report = now;
+    }
+
+    out[count++] = frame;
+    return count;
+}
@@ -0,0 +1,41 @@
+#include "pointer_accel.h"
+
+// Curve shape at t in [0, 256], result in [0, 256]
+static uint32_t pointer_accel_shape(uint8_t curve, uint32_t t) {
+    switch (curve) {
+        case POINTER_ACCEL_LINEAR:
+            return t;
+        case POINTER_ACCEL_QUADRATIC:
+            return (t * t) >> 8;
+        case POINTER_ACCEL_SMOOTHSTEP:
+            // 3t^2 - 2t^3
+            return (t * t * (3 * 256 - 2 * t)) >> 16;
+        default:
+            return 0;
+    }
+}
+
+void pointer_accel_build_lut(uint16_t lut[POINTER_ACCEL_LUT_SIZE], const struct pointer_accel_params *params,
+                             uint8_t sensitivity) {
+    const uint32_t low = params->knee_low;
+    const uint32_t high = MAX(params->knee_high, params->knee_low + 1);
+
+    for (uint32_t speed = 0; speed < POINTER_ACCEL_LUT_SIZE; speed++) {
+        uint32_t gain = 128;
+
+        if (params->curve != POINTER_ACCEL_NONE) {
+            uint32_t t = 0;
+            if (speed >= high) {
+                t = 256;
+            } else if (speed > low) {
+                t = ((speed - low) << 8) / (high - low);
+            }
+
+            // Interpolate between min and max gain, either may be the larger one
+            int32_t span = (int32_t)params->max_gain - (int32_t)params->min_gain;
+            gain = params->min_gain + (span * (int32_t)pointer_accel_shape(params->curve, t)) / 256;
+        }
+
+        lut[speed] = (uint16_t)((sensitivity * gain) >> 7);
+    }
+}
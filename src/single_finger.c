@@ -1,7 +1,6 @@
-#include <zephyr/input/input.h>
-#include <zephyr/dt-bindings/input/input-event-codes.h>
 #include <math.h>
 #include "gesture_handlers.h"
+#include "gesture_recognizer.h"
 
 
 void handle_single_finger_gestures(const struct device *dev, const struct iqs5xx_rawdata *data, struct gesture_state *state) {
@@ -17,20 +16,20 @@ void handle_single_finger_gestures(const struct device *dev, const struct iqs5xx
                 }
 
                 if (!state->isDragging) {
-                    send_input_event(INPUT_EV_KEY, INPUT_BTN_0, 1, true);
-                    send_input_event(INPUT_EV_KEY, INPUT_BTN_0, 0, true);
+                    send_input_event(dev, INPUT_EV_KEY, INPUT_BTN_0, 1, true);
+                    send_input_event(dev, INPUT_EV_KEY, INPUT_BTN_0, 0, true);
                 }
                 break;
 
             case GESTURE_TAP_AND_HOLD:
                 // IMMEDIATE drag start - only send button press ONCE (like working code)
                 if (!state->isDragging) {
-                    send_input_event(INPUT_EV_KEY, INPUT_BTN_0, 1, true);
+                    send_input_event(dev, INPUT_EV_KEY, INPUT_BTN_0, 1, true);
                     state->isDragging = true;
                     state->dragStartSent = true;
                 } else if (state->isDragging && !state->dragStartSent) {
                     // Drag state exists but button wasn't sent - fix it
-                    send_input_event(INPUT_EV_KEY, INPUT_BTN_0, 1, true);
+                    send_input_event(dev, INPUT_EV_KEY, INPUT_BTN_0, 1, true);
                     state->dragStartSent = true;
                 }
                 break;
@@ -42,7 +41,31 @@ void handle_single_finger_gestures(const struct device *dev, const struct iqs5xx
 
     // Movement handling for single finger (following working code pattern)
     if (data->finger_count == 1) {
-        float sensMp = (float)state->mouseSensitivity / 128.0F;
+#ifdef CONFIG_IQS5XX_FIXED_POINT
+        // Process movement if we have any
+        if (data->rx != 0 || data->ry != 0) {
+            // Accumulate in 1/128 px, the accelerated sensitivity is already Q7
+            const int32_t gain = state->profile->gain_lut[pointer_accel_index(data->rx, data->ry)];
+            state->accumPos.x += data->rx * gain;
+            state->accumPos.y += data->ry * gain;
+
+            // Division truncates toward zero, like the float to int cast
+            int16_t xp = (int16_t)(state->accumPos.x / GESTURE_SENS_ONE);
+            int16_t yp = (int16_t)(state->accumPos.y / GESTURE_SENS_ONE);
+
+            if (abs(state->accumPos.x) >= MOVEMENT_THRESHOLD_Q7 || abs(state->accumPos.y) >= MOVEMENT_THRESHOLD_Q7) {
+
+                // Send movement events (works for both normal movement and drag)
+                send_input_event(dev, INPUT_EV_REL, INPUT_REL_X, xp, false);
+                send_input_event(dev, INPUT_EV_REL, INPUT_REL_Y, yp, true);
+
+                // Reset accumulation, keeping fractional part
+                state->accumPos.x -= xp * GESTURE_SENS_ONE;
+                state->accumPos.y -= yp * GESTURE_SENS_ONE;
+            }
+        }
+#else
+        float sensMp = (float)state->profile->gain_lut[pointer_accel_index(data->rx, data->ry)] / 128.0F;
 
         // Process movement if we have any
         if (data->rx != 0 || data->ry != 0) {
@@ -57,21 +80,22 @@ void handle_single_finger_gestures(const struct device *dev, const struct iqs5xx
             if (fabsf(state->accumPos.x) >= MOVEMENT_THRESHOLD || fabsf(state->accumPos.y) >= MOVEMENT_THRESHOLD) {
 
                 // Send movement events (works for both normal movement and drag)
-                send_input_event(INPUT_EV_REL, INPUT_REL_X, xp, false);
-                send_input_event(INPUT_EV_REL, INPUT_REL_Y, yp, true);
+                send_input_event(dev, INPUT_EV_REL, INPUT_REL_X, xp, false);
+                send_input_event(dev, INPUT_EV_REL, INPUT_REL_Y, yp, true);
 
                 // Reset accumulation, keeping fractional part
                 state->accumPos.x -= xp;
                 state->accumPos.y -= yp;
             }
         }
+#endif
     }
 }
 
-void reset_single_finger_state(struct gesture_state *state) {
+void reset_single_finger_state(const struct device *dev, struct gesture_state *state) {
     // IMMEDIATE drag release when fingers are lifted (like working code)
     if (state->isDragging && state->dragStartSent) {
-        send_input_event(INPUT_EV_KEY, INPUT_BTN_0, 0, true);
+        send_input_event(dev, INPUT_EV_KEY, INPUT_BTN_0, 0, true);
         state->isDragging = false;
         state->dragStartSent = false;
     }
@@ -82,3 +106,16 @@ void reset_single_finger_state(struct gesture_state *state) {
         state->accumPos.y = 0;
     }
 }
+
+static bool single_finger_active(const struct gesture_state *state) {
+    return state->isDragging;
+}
+
+const struct gesture_recognizer single_finger_recognizer = {
+    .handle = handle_single_finger_gestures,
+    .reset = reset_single_finger_state,
+    .active = single_finger_active,
+    // Taps and tap-and-hold, ignored while a multi finger session is open
+    .events = GESTURE_RECOGNIZER_EV_GESTURES0,
+    .events_exclusive = true,
+};
@@ -0,0 +1,279 @@
+#include <stdlib.h>
+#include "gesture_handlers.h"
+#include "gesture_recognizer.h"
+
+// Centroid movement that is counted as a swipe, and below which a three finger tap is a click (px)
+#define SWIPE_DISTANCE          CONFIG_IQS5XX_SWIPE_DISTANCE
+#define SWIPE_TAP_SLOP          10
+// The dominant axis must be this many times the other one
+#define SWIPE_AXIS_RATIO        2
+
+enum swipe_direction {
+    SWIPE_UP,
+    SWIPE_DOWN,
+    SWIPE_LEFT,
+    SWIPE_RIGHT,
+    SWIPE_DIRECTION_COUNT,
+};
+
+// Host shortcuts: overview, application windows / desktop, next desktop, previous desktop
+#if defined(CONFIG_IQS5XX_HOST_MACOS)
+#define SWIPE_WINDOWS_ACTION    (&swipe_windows_seq)
+
+TRACKPAD_ACTION_SEQ_DEFINE(swipe_overview_seq,
+    TRACKPAD_ACTION_CLEAR(10),
+    TRACKPAD_ACTION_PRESS(LEFT_CONTROL, 10),
+    TRACKPAD_ACTION_PRESS(UP_ARROW, 30),
+    TRACKPAD_ACTION_RELEASE(UP_ARROW, 5),
+    TRACKPAD_ACTION_RELEASE(LEFT_CONTROL, 10),
+    TRACKPAD_ACTION_CLEAR(30)
+);
+
+TRACKPAD_ACTION_SEQ_DEFINE(swipe_windows_seq,
+    TRACKPAD_ACTION_CLEAR(10),
+    TRACKPAD_ACTION_PRESS(LEFT_CONTROL, 10),
+    TRACKPAD_ACTION_PRESS(DOWN_ARROW, 30),
+    TRACKPAD_ACTION_RELEASE(DOWN_ARROW, 5),
+    TRACKPAD_ACTION_RELEASE(LEFT_CONTROL, 10),
+    TRACKPAD_ACTION_CLEAR(30)
+);
+
+TRACKPAD_ACTION_SEQ_DEFINE(swipe_next_desktop_seq,
+    TRACKPAD_ACTION_CLEAR(10),
+    TRACKPAD_ACTION_PRESS(LEFT_CONTROL, 10),
+    TRACKPAD_ACTION_PRESS(RIGHT_ARROW, 30),
+    TRACKPAD_ACTION_RELEASE(RIGHT_ARROW, 5),
+    TRACKPAD_ACTION_RELEASE(LEFT_CONTROL, 10),
+    TRACKPAD_ACTION_CLEAR(30)
+);
+
+TRACKPAD_ACTION_SEQ_DEFINE(swipe_prev_desktop_seq,
+    TRACKPAD_ACTION_CLEAR(10),
+    TRACKPAD_ACTION_PRESS(LEFT_CONTROL, 10),
+    TRACKPAD_ACTION_PRESS(LEFT_ARROW, 30),
+    TRACKPAD_ACTION_RELEASE(LEFT_ARROW, 5),
+    TRACKPAD_ACTION_RELEASE(LEFT_CONTROL, 10),
+    TRACKPAD_ACTION_CLEAR(30)
+);
+#elif defined(CONFIG_IQS5XX_HOST_WINDOWS)
+#define SWIPE_WINDOWS_ACTION    (&swipe_windows_seq)
+
+// Task view, show desktop, Ctrl + Win + Right / Left
+TRACKPAD_ACTION_SEQ_DEFINE(swipe_overview_seq,
+    TRACKPAD_ACTION_CLEAR(10),
+    TRACKPAD_ACTION_PRESS(LEFT_GUI, 10),
+    TRACKPAD_ACTION_PRESS(TAB, 30),
+    TRACKPAD_ACTION_RELEASE(TAB, 5),
+    TRACKPAD_ACTION_RELEASE(LEFT_GUI, 10),
+    TRACKPAD_ACTION_CLEAR(30)
+);
+
+TRACKPAD_ACTION_SEQ_DEFINE(swipe_windows_seq,
+    TRACKPAD_ACTION_CLEAR(10),
+    TRACKPAD_ACTION_PRESS(LEFT_GUI, 10),
+    TRACKPAD_ACTION_PRESS(D, 30),
+    TRACKPAD_ACTION_RELEASE(D, 5),
+    TRACKPAD_ACTION_RELEASE(LEFT_GUI, 10),
+    TRACKPAD_ACTION_CLEAR(30)
+);
+
+TRACKPAD_ACTION_SEQ_DEFINE(swipe_next_desktop_seq,
+    TRACKPAD_ACTION_CLEAR(10),
+    TRACKPAD_ACTION_PRESS(LEFT_CONTROL, 10),
+    TRACKPAD_ACTION_PRESS(LEFT_GUI, 10),
+    TRACKPAD_ACTION_PRESS(RIGHT_ARROW, 30),
+    TRACKPAD_ACTION_RELEASE(RIGHT_ARROW, 5),
+    TRACKPAD_ACTION_RELEASE(LEFT_GUI, 5),
+    TRACKPAD_ACTION_RELEASE(LEFT_CONTROL, 10),
+    TRACKPAD_ACTION_CLEAR(30)
+);
+
+TRACKPAD_ACTION_SEQ_DEFINE(swipe_prev_desktop_seq,
+    TRACKPAD_ACTION_CLEAR(10),
+    TRACKPAD_ACTION_PRESS(LEFT_CONTROL, 10),
+    TRACKPAD_ACTION_PRESS(LEFT_GUI, 10),
+    TRACKPAD_ACTION_PRESS(LEFT_ARROW, 30),
+    TRACKPAD_ACTION_RELEASE(LEFT_ARROW, 5),
+    TRACKPAD_ACTION_RELEASE(LEFT_GUI, 5),
+    TRACKPAD_ACTION_RELEASE(LEFT_CONTROL, 10),
+    TRACKPAD_ACTION_CLEAR(30)
+);
+#else
+// Activities overview (Super), Ctrl + Alt + Right / Left
+TRACKPAD_ACTION_SEQ_DEFINE(swipe_overview_seq,
+    TRACKPAD_ACTION_CLEAR(10),
+    TRACKPAD_ACTION_PRESS(LEFT_GUI, 30),
+    TRACKPAD_ACTION_RELEASE(LEFT_GUI, 10),
+    TRACKPAD_ACTION_CLEAR(30)
+);
+
+// No application windows view
+#define SWIPE_WINDOWS_ACTION    NULL
+
+TRACKPAD_ACTION_SEQ_DEFINE(swipe_next_desktop_seq,
+    TRACKPAD_ACTION_CLEAR(10),
+    TRACKPAD_ACTION_PRESS(LEFT_CONTROL, 10),
+    TRACKPAD_ACTION_PRESS(LEFT_ALT, 10),
+    TRACKPAD_ACTION_PRESS(RIGHT_ARROW, 30),
+    TRACKPAD_ACTION_RELEASE(RIGHT_ARROW, 5),
+    TRACKPAD_ACTION_RELEASE(LEFT_ALT, 5),
+    TRACKPAD_ACTION_RELEASE(LEFT_CONTROL, 10),
+    TRACKPAD_ACTION_CLEAR(30)
+);
+
+TRACKPAD_ACTION_SEQ_DEFINE(swipe_prev_desktop_seq,
+    TRACKPAD_ACTION_CLEAR(10),
+    TRACKPAD_ACTION_PRESS(LEFT_CONTROL, 10),
+    TRACKPAD_ACTION_PRESS(LEFT_ALT, 10),
+    TRACKPAD_ACTION_PRESS(LEFT_ARROW, 30),
+    TRACKPAD_ACTION_RELEASE(LEFT_ARROW, 5),
+    TRACKPAD_ACTION_RELEASE(LEFT_ALT, 5),
+    TRACKPAD_ACTION_RELEASE(LEFT_CONTROL, 10),
+    TRACKPAD_ACTION_CLEAR(30)
+);
+#endif
+
+// Fingers moving left bring in the desktop on the right, as on a touchpad
+#define SWIPE_DEFAULT_ACTIONS {                     \
+        [SWIPE_UP] = &swipe_overview_seq,           \
+        [SWIPE_DOWN] = SWIPE_WINDOWS_ACTION,        \
+        [SWIPE_LEFT] = &swipe_next_desktop_seq,     \
+        [SWIPE_RIGHT] = &swipe_prev_desktop_seq,    \
+    }
+
+// Action per finger count (3, 4, 5) and direction, NULL for none
+static const struct trackpad_action_seq *const swipe_actions[3][SWIPE_DIRECTION_COUNT] = {
+    SWIPE_DEFAULT_ACTIONS,
+    SWIPE_DEFAULT_ACTIONS,
+    SWIPE_DEFAULT_ACTIONS,
+};
+
+// Starts measuring from the current centroid, on touch down and when the contact set changes
+static void swipe_rebase(struct swipe_session *sw, const struct gesture_state *state,
+                         uint8_t fingers, int32_t cx, int32_t cy) {
+    sw->fingers = fingers;
+    sw->max_fingers = MAX(sw->max_fingers, fingers);
+    sw->start_x = cx;
+    sw->start_y = cy;
+    for (uint8_t i = 0; i < fingers; i++) {
+        sw->contact_ids[i] = contact_tracker_get(&state->contacts, i)->id;
+    }
+}
+
+static bool swipe_same_contacts(const struct swipe_session *sw, const struct gesture_state *state,
+                                uint8_t fingers) {
+    if (sw->fingers != fingers) {
+        return false;
+    }
+    for (uint8_t i = 0; i < fingers; i++) {
+        if (sw->contact_ids[i] != contact_tracker_get(&state->contacts, i)->id) {
+            return false;
+        }
+    }
+    return true;
+}
+
+static void handle_swipe_gestures(const struct device *dev, const struct iqs5xx_rawdata *data,
+                                  struct gesture_state *state) {
+    struct swipe_session *sw = &state->swipe;
+    const uint8_t fingers = MIN(data->finger_count, IQS5XX_MAX_FINGERS);
+
+    if (fingers < 3) {
+        return;
+    }
+
+    // Centroid position and velocity, once per frame
+    int32_t cx = 0, cy = 0, vx = 0, vy = 0;
+    for (uint8_t i = 0; i < fingers; i++) {
+        const struct tracked_contact *c = contact_tracker_get(&state->contacts, i);
+
+        cx += c->x;
+        cy += c->y;
+        vx += c->vx;
+        vy += c->vy;
+    }
+    cx /= fingers;
+    cy /= fingers;
+    vx /= fingers;
+    vy /= fingers;
+
+    if (!sw->active) {
+        sw->active = true;
+        sw->spent = false;
+        sw->moved = false;
+        sw->max_fingers = 0;
+        sw->start_time = gesture_uptime_get();
+        swipe_rebase(sw, state, fingers, cx, cy);
+        return;
+    }
+
+    if (!swipe_same_contacts(sw, state, fingers)) {
+        // Finger joined, left or was swapped, the centroid jumps
+        swipe_rebase(sw, state, fingers, cx, cy);
+        return;
+    }
+
+    int32_t dx = cx - sw->start_x;
+    int32_t dy = cy - sw->start_y;
+
+    if (abs(dx) > SWIPE_TAP_SLOP || abs(dy) > SWIPE_TAP_SLOP) {
+        sw->moved = true;
+    }
+
+    // One action per touch, until fewer than three fingers remain
+    if (sw->spent) {
+        return;
+    }
+
+    // Extrapolate by the centroid velocity, decides on the frame before the threshold is crossed
+    int32_t px = dx + (vx * CONFIG_IQS5XX_SWIPE_LOOKAHEAD_MS) / 1000;
+    int32_t py = dy + (vy * CONFIG_IQS5XX_SWIPE_LOOKAHEAD_MS) / 1000;
+    enum swipe_direction dir;
+
+    if (abs(px) >= SWIPE_DISTANCE && abs(px) > SWIPE_AXIS_RATIO * abs(py)) {
+        dir = (px < 0) ? SWIPE_LEFT : SWIPE_RIGHT;
+    } else if (abs(py) >= SWIPE_DISTANCE && abs(py) > SWIPE_AXIS_RATIO * abs(px)) {
+        dir = (py < 0) ? SWIPE_UP : SWIPE_DOWN;
+    } else {
+        return;
+    }
+
+    const struct trackpad_action_seq *seq = swipe_actions[fingers - 3][dir];
+    if (seq != NULL) {
+        gesture_play_keys(seq);
+    }
+    sw->spent = true;
+}
+
+// Ends the session, a short three finger touch without movement is a middle click
+static void swipe_end(const struct device *dev, struct gesture_state *state, bool lifted) {
+    struct swipe_session *sw = &state->swipe;
+
+    if (sw->active && lifted && !sw->spent && !sw->moved && sw->max_fingers == 3 &&
+        gesture_uptime_get() - sw->start_time < TRACKPAD_THREE_FINGER_CLICK_TIME) {
+        send_input_event(dev, INPUT_EV_KEY, INPUT_BTN_2, 1, false);
+        send_input_event(dev, INPUT_EV_KEY, INPUT_BTN_2, 0, true);
+    }
+
+    sw->active = false;
+}
+
+static void reset_swipe_state(const struct device *dev, struct gesture_state *state) {
+    swipe_end(dev, state, true);
+}
+
+static void cancel_swipe_state(const struct device *dev, struct gesture_state *state) {
+    swipe_end(dev, state, false);
+}
+
+static bool swipe_active(const struct gesture_state *state) {
+    return state->swipe.active;
+}
+
+const struct gesture_recognizer swipe_recognizer = {
+    .handle = handle_swipe_gestures,
+    .reset = reset_swipe_state,
+    .cancel = cancel_swipe_state,
+    .active = swipe_active,
+    .owns_event_frames = true,
+};
@@ -4,19 +4,11 @@
  * SPDX-License-Identifier: MIT
  */
 
-#include <zephyr/input/input.h>
-#include <zephyr/dt-bindings/input/input-event-codes.h>
-#include <dt-bindings/zmk/keys.h>
-#include <zmk/hid.h>
-#include <zmk/endpoints.h>
-#include "iqs5xx.h"
 #include "gesture_handlers.h"
-#include "trackpad_keyboard_events.h"
+#include "gesture_recognizer.h"
 
 
-// Global cooldown to prevent gesture re-triggering
-static int64_t global_gesture_cooldown = 0;
-
+#ifndef CONFIG_IQS5XX_FIXED_POINT
 // Calculate average Y position of fingers
 static float calculate_average_y(const struct iqs5xx_rawdata *data, int finger_count) {
     float sum = 0;
@@ -25,88 +17,27 @@ static float calculate_average_y(const struct iqs5xx_rawdata *data, int finger_c
     }
     return sum / finger_count;
 }
-
-// FIXED: Proper state cleanup after Mission Control
-static void send_control_up(void) {
-    // Clear any existing HID state first
-    zmk_hid_keyboard_clear();
-    zmk_endpoints_send_report(HID_USAGE_KEY);
-    k_msleep(10);
-
-    // Press Control
-    int ret1 = zmk_hid_keyboard_press(LEFT_CONTROL);
-    if (ret1 < 0) {
-        return;
-    }
-    zmk_endpoints_send_report(HID_USAGE_KEY);
-    k_msleep(10);
-
-    // Press Up Arrow
-    int ret2 = zmk_hid_keyboard_press(UP_ARROW);
-    if (ret2 < 0) {
-        zmk_hid_keyboard_release(LEFT_CONTROL);
-        zmk_endpoints_send_report(HID_USAGE_KEY);
-        return;
-    }
-    zmk_endpoints_send_report(HID_USAGE_KEY);
-    k_msleep(30); // Reduced hold time
-
-    // Release Up Arrow
-    zmk_hid_keyboard_release(UP_ARROW);
-    zmk_endpoints_send_report(HID_USAGE_KEY);
-    k_msleep(5);
-
-    // Release Control
-    zmk_hid_keyboard_release(LEFT_CONTROL);
-    zmk_endpoints_send_report(HID_USAGE_KEY);
-    k_msleep(10);
-
-    // CRITICAL FIX: Complete cleanup after Mission Control
-    zmk_hid_keyboard_clear();
-    zmk_endpoints_send_report(HID_USAGE_KEY);
-    k_msleep(30); // Reduced cleanup time
-}
-
-// FIXED: Proper state cleanup after Application Windows
-static void send_control_down(void) {
-    // Clear any existing HID state first
-    zmk_hid_keyboard_clear();
-    zmk_endpoints_send_report(HID_USAGE_KEY);
-    k_msleep(10);
-
-    // Press Control
-    int ret1 = zmk_hid_keyboard_press(LEFT_CONTROL);
-    if (ret1 < 0) {
-        return;
-    }
-    zmk_endpoints_send_report(HID_USAGE_KEY);
-    k_msleep(10);
-
-    // Press Down Arrow
-    int ret2 = zmk_hid_keyboard_press(UP_ARROW);
-    if (ret2 < 0) {
-        zmk_hid_keyboard_release(LEFT_CONTROL);
-        zmk_endpoints_send_report(HID_USAGE_KEY);
-        return;
-    }
-    zmk_endpoints_send_report(HID_USAGE_KEY);
-    k_msleep(30); // Reduced hold time
-
-    // Release Down Arrow
-    zmk_hid_keyboard_release(UP_ARROW);
-    zmk_endpoints_send_report(HID_USAGE_KEY);
-    k_msleep(5);
-
-    // Release Control
-    zmk_hid_keyboard_release(LEFT_CONTROL);
-    zmk_endpoints_send_report(HID_USAGE_KEY);
-    k_msleep(10);
-
-    // CRITICAL FIX: Complete cleanup after Application Windows
-    zmk_hid_keyboard_clear();
-    zmk_endpoints_send_report(HID_USAGE_KEY);
-    k_msleep(30); // Reduced cleanup time
-}
+#endif
+
+// Mission Control: Ctrl + Up, with full HID cleanup before and after
+TRACKPAD_ACTION_SEQ_DEFINE(control_up_seq,
+    TRACKPAD_ACTION_CLEAR(10),
+    TRACKPAD_ACTION_PRESS(LEFT_CONTROL, 10),
+    TRACKPAD_ACTION_PRESS(UP_ARROW, 30),
+    TRACKPAD_ACTION_RELEASE(UP_ARROW, 5),
+    TRACKPAD_ACTION_RELEASE(LEFT_CONTROL, 10),
+    TRACKPAD_ACTION_CLEAR(30)
+);
+
+// Application Windows: Ctrl + Down, with full HID cleanup before and after
+TRACKPAD_ACTION_SEQ_DEFINE(control_down_seq,
+    TRACKPAD_ACTION_CLEAR(10),
+    TRACKPAD_ACTION_PRESS(LEFT_CONTROL, 10),
+    TRACKPAD_ACTION_PRESS(DOWN_ARROW, 30),
+    TRACKPAD_ACTION_RELEASE(DOWN_ARROW, 5),
+    TRACKPAD_ACTION_RELEASE(LEFT_CONTROL, 10),
+    TRACKPAD_ACTION_CLEAR(30)
+);
 
 void handle_three_finger_gestures(const struct device *dev, const struct iqs5xx_rawdata *data, struct gesture_state *state) {
     // Early exit if not exactly three fingers
@@ -114,21 +45,30 @@ void handle_three_finger_gestures(const struct device *dev, const struct iqs5xx_
         return;
     }
 
-    int64_t current_time = k_uptime_get();
+    int64_t current_time = gesture_uptime_get();
 
-    // Check global cooldown - block all processing if too recent
-    if (current_time - global_gesture_cooldown < 500) { // Reduced to 500ms cooldown
+    // Check cooldown - block all processing if too recent
+    if (current_time - state->threeFingerCooldown < 500) { // Reduced to 500ms cooldown
         return;
     }
 
+    bool same_contacts = true;
+    for (int i = 0; i < 3; i++) {
+        same_contacts = same_contacts &&
+                        (state->threeFingerIds[i] == contact_tracker_get(&state->contacts, i)->id);
+    }
+
     // Initialize three finger tracking if just started
-    if (!state->threeFingersPressed) {
-        state->threeFingerPressTime = current_time;
-        state->threeFingersPressed = true;
-        state->gestureTriggered = false;
+    if (!state->threeFingersPressed || !same_contacts) {
+        if (!state->threeFingersPressed) {
+            state->threeFingerPressTime = current_time;
+            state->threeFingersPressed = true;
+            state->gestureTriggered = false;
+        }
 
-        // Store initial positions for swipe detection
+        // Store initial positions for swipe detection, again if a finger was swapped
         for (int i = 0; i < 3; i++) {
+            state->threeFingerIds[i] = contact_tracker_get(&state->contacts, i)->id;
             state->threeFingerStartPos[i].x = data->fingers[i].ax;
             state->threeFingerStartPos[i].y = data->fingers[i].ay;
         }
@@ -145,6 +85,16 @@ void handle_three_finger_gestures(const struct device *dev, const struct iqs5xx_
     if (time_since_start > 150 && // Wait 150ms before checking swipes
         data->fingers[0].strength > 0 && data->fingers[1].strength > 0 && data->fingers[2].strength > 0) {
 
+#ifdef CONFIG_IQS5XX_FIXED_POINT
+        // Summed movement in Y direction, three times the average
+        int32_t yMovement = (data->fingers[0].ay + data->fingers[1].ay + data->fingers[2].ay) -
+                            (state->threeFingerStartPos[0].y +
+                             state->threeFingerStartPos[1].y +
+                             state->threeFingerStartPos[2].y);
+
+        // Detect significant movement (reduced threshold for better responsiveness)
+        if (abs(yMovement) > 3 * 30) {
+#else
         // Calculate average movement in Y direction
         float initialAvgY = (float)(state->threeFingerStartPos[0].y +
                            state->threeFingerStartPos[1].y +
@@ -154,17 +104,18 @@ void handle_three_finger_gestures(const struct device *dev, const struct iqs5xx_
 
         // Detect significant movement (reduced threshold for better responsiveness)
         if (fabsf(yMovement) > 30.0f) {
+#endif
             if (yMovement > 0) {
                 // SWIPE DOWN = Application Windows (App Exposé)
-                send_control_down();
+                gesture_play_keys(&control_down_seq);
             } else {
                 // SWIPE UP = Mission Control
-                send_control_up();
+                gesture_play_keys(&control_up_seq);
             }
 
             // CRITICAL FIX: Complete state cleanup after gesture
             state->gestureTriggered = true;
-            global_gesture_cooldown = current_time;
+            state->threeFingerCooldown = current_time;
             state->threeFingersPressed = false;
 
             // Only reset three finger state to avoid interfering with other gestures
@@ -173,15 +124,15 @@ void handle_three_finger_gestures(const struct device *dev, const struct iqs5xx_
     }
 }
 
-void reset_three_finger_state(struct gesture_state *state) {
+void reset_three_finger_state(const struct device *dev, struct gesture_state *state) {
     // Handle three finger click (if fingers released quickly without swipe)
     if (state->threeFingersPressed && !state->gestureTriggered &&
-        k_uptime_get() - state->threeFingerPressTime < TRACKPAD_THREE_FINGER_CLICK_TIME) {
+        gesture_uptime_get() - state->threeFingerPressTime < TRACKPAD_THREE_FINGER_CLICK_TIME) {
 
         // Check if we're in gesture cooldown
-        if (k_uptime_get() - global_gesture_cooldown > 500) {
-            send_input_event(INPUT_EV_KEY, INPUT_BTN_2, 1, false);
-            send_input_event(INPUT_EV_KEY, INPUT_BTN_2, 0, true);
+        if (gesture_uptime_get() - state->threeFingerCooldown > 500) {
+            send_input_event(dev, INPUT_EV_KEY, INPUT_BTN_2, 1, false);
+            send_input_event(dev, INPUT_EV_KEY, INPUT_BTN_2, 0, true);
         }
     }
 
@@ -190,3 +141,21 @@ void reset_three_finger_state(struct gesture_state *state) {
         state->gestureTriggered = false;
     }
 }
+
+static void three_finger_cancel(const struct device *dev, struct gesture_state *state) {
+    // No middle click for a rejected contact set
+    state->threeFingersPressed = false;
+    state->gestureTriggered = false;
+}
+
+static bool three_finger_active(const struct gesture_state *state) {
+    return state->threeFingersPressed;
+}
+
+const struct gesture_recognizer three_finger_recognizer = {
+    .handle = handle_three_finger_gestures,
+    .reset = reset_three_finger_state,
+    .cancel = three_finger_cancel,
+    .active = three_finger_active,
+    .owns_event_frames = true,
+};
@@ -8,197 +8,550 @@
 #include <dt-bindings/zmk/keys.h>
 #include <zmk/hid.h>
 #include <zmk/endpoints.h>
+#include <zmk/activity.h>
+#include <zmk/event_manager.h>
+#include <zmk/events/activity_state_changed.h>
+#include <zmk/events/position_state_changed.h>
+#ifdef CONFIG_IQS5XX_PROFILE_FOLLOW_LAYERS
+#include <zmk/keymap.h>
+#include <zmk/events/layer_state_changed.h>
+#endif
+#include <zephyr/pm/device.h>
 #include "iqs5xx.h"
 #include "gesture_handlers.h"
+#include "gesture_recognizer.h"
 #include "trackpad_keyboard_events.h"
+#include "iqs5xx_latency.h"
+#include "trackpad_profile.h"
+#include "trackpad_stats.h"
+#include "motion_coalescer.h"
 
 
-static struct gesture_state g_gesture_state = {0};
-static const struct device *trackpad;
-static const struct device *trackpad_device = NULL;
-static int event_count = 0;
-static int64_t last_event_time = 0; // For rate-limiting
-static int64_t last_activity_time = 0; // For idle detection
-static bool is_idle_mode = false;
-
-// Optimized input event sending
-void send_input_event(uint8_t type, uint16_t code, int32_t value, bool sync) {
-    event_count++;
-    
-    // Reset event counter periodically to prevent overflow
-    if (event_count > 1000000) {
-        event_count = 0;
-    }
-    
-    // Update activity time for any significant event
-    if (type == INPUT_EV_KEY || abs(value) > 2) {
-        last_activity_time = k_uptime_get();
-        is_idle_mode = false;
-    }
-    
-    // Log important events
-    if (type == INPUT_EV_KEY) {
-        // Button press/release
-    } else if (abs(value) > 5) { // Only log significant movements
-        // Mouse movement
-    }
-
-    if (trackpad_device) {
-        int ret = input_report(trackpad_device, type, code, value, sync, K_NO_WAIT);
-        if (ret < 0) {
-            return;
+#ifdef CONFIG_IQS5XX_INPUT_BATCH
+// Input events of one frame, reported with a single sync
+#define TRACKPAD_BATCH_SIZE     8
+
+struct trackpad_batch_event {
+    uint8_t type;
+    uint16_t code;
+    int32_t value;
+};
+
+struct trackpad_batch {
+    // Set while a frame is dispatched
+    bool open;
+    uint8_t len;
+    struct trackpad_batch_event events[TRACKPAD_BATCH_SIZE];
+};
+#endif
+
+// Per trackpad gesture and reporting state
+struct trackpad_ctx {
+    const struct device *dev;
+    struct gesture_state gesture;
+    // Profile table from devicetree, and the selected entry picked up by the next frame
+    struct trackpad_profile *profiles;
+    uint8_t profile_count;
+    atomic_ptr_t profile;
+    // Writes the chip settings of a newly selected profile
+    struct k_work profile_work;
+    // Chip settings in place before the applied profile overrode them, -1 while not overridden
+    int32_t base_active_rr;
+    int32_t base_single_finger_gestures;
+    int32_t base_multi_finger_gestures;
+    // Report interval rate limiter
+    struct motion_coalescer coalescer;
+    // Frames received, held back by the rate limiter and dropped by the typing guard
+    uint32_t frames;
+    uint32_t rate_limited;
+    uint32_t typing_dropped;
+#ifdef CONFIG_IQS5XX_INPUT_BATCH
+    struct trackpad_batch batch;
+#endif
+#if CONFIG_IQS5XX_TYPING_GUARD_ACTIVE_RR > 0
+    // Active refresh rate to restore after typing
+    uint16_t saved_active_rr;
+#endif
+};
+
+// Every software recognizer enabled, bit n for n fingers
+#define TRACKPAD_PROFILE_ALL_FINGERS    (BIT_MASK(TRACKPAD_PROFILE_MAX_FINGERS + 1) & ~BIT(0))
+
+// Profile property, from the profile node or else the trackpad node
+#define TRACKPAD_PROFILE_PROP(node_id, parent, prop, default_value)                             \
+    DT_PROP_OR(node_id, prop, DT_PROP_OR(parent, prop, default_value))
+
+#define TRACKPAD_PROFILE_LAYER_BIT(node_id, prop, idx)  BIT(DT_PROP_BY_IDX(node_id, prop, idx)) |
+
+#define TRACKPAD_PROFILE_LAYERS(node_id)                                                        \
+    COND_CODE_1(DT_NODE_HAS_PROP(node_id, layers),                                              \
+                (DT_FOREACH_PROP_ELEM(node_id, layers, TRACKPAD_PROFILE_LAYER_BIT) 0), (0))
+
+// Frame handling settings, the gain LUT and recognizer table are filled in at boot
+#define TRACKPAD_PROFILE_DT(node_id, parent)                                                    \
+    .sensitivity = (uint8_t)CLAMP(TRACKPAD_PROFILE_PROP(node_id, parent, sensitivity, 128), 64, 255), \
+    .accel = {                                                                                  \
+        .curve = DT_ENUM_IDX_OR(node_id, accel_curve,                                           \
+                                DT_ENUM_IDX_OR(parent, accel_curve, POINTER_ACCEL_NONE)),       \
+        .knee_low = TRACKPAD_PROFILE_PROP(node_id, parent, accel_knee_low, 2),                  \
+        .knee_high = TRACKPAD_PROFILE_PROP(node_id, parent, accel_knee_high, 16),               \
+        .min_gain = TRACKPAD_PROFILE_PROP(node_id, parent, accel_min_gain, 128),                \
+        .max_gain = TRACKPAD_PROFILE_PROP(node_id, parent, accel_max_gain, 128),                \
+    },                                                                                          \
+    .recognizer_fingers = DT_PROP_OR(node_id, gesture_finger_mask, TRACKPAD_PROFILE_ALL_FINGERS), \
+    .report_interval = TRACKPAD_PROFILE_PROP(node_id, parent, report_interval_ms, 20),          \
+    .scroll_sensitivity = TRACKPAD_PROFILE_PROP(node_id, parent, scroll_sensitivity, 3),        \
+    .scroll_threshold = TRACKPAD_PROFILE_PROP(node_id, parent, scroll_threshold, 25),           \
+    .zoom_threshold = TRACKPAD_PROFILE_PROP(node_id, parent, zoom_threshold, 100),              \
+    .finger_strength_min = DT_PROP_OR(parent, finger_strength_min, 0),
+
+// Profile 0, the trackpad node keeps the chip settings it programmed at boot
+#define TRACKPAD_PROFILE_BASE(node_id) {                                                        \
+        TRACKPAD_PROFILE_DT(node_id, node_id)                                                   \
+        .active_rr = -1,                                                                        \
+        .single_finger_gestures = -1,                                                           \
+        .multi_finger_gestures = -1,                                                            \
+    },
+
+#define TRACKPAD_PROFILE_CHILD(node_id) {                                                       \
+        TRACKPAD_PROFILE_DT(node_id, DT_PARENT(node_id))                                        \
+        .active_rr = DT_PROP_OR(node_id, refresh_rate_active, -1),                              \
+        .single_finger_gestures = DT_PROP_OR(node_id, single_finger_gestures, -1),              \
+        .multi_finger_gestures = DT_PROP_OR(node_id, multi_finger_gestures, -1),                \
+        .layers = TRACKPAD_PROFILE_LAYERS(node_id),                                             \
+    },
+
+#define TRACKPAD_PROFILES_NAME(node_id) _CONCAT(trackpad_profiles_, DT_DEP_ORD(node_id))
+
+#define TRACKPAD_PROFILES_DEFINE(node_id)                                                       \
+    static struct trackpad_profile TRACKPAD_PROFILES_NAME(node_id)[] = {                        \
+        TRACKPAD_PROFILE_BASE(node_id)                                                          \
+        DT_FOREACH_CHILD_STATUS_OKAY(node_id, TRACKPAD_PROFILE_CHILD)                           \
+    };
+
+DT_FOREACH_STATUS_OKAY(azoteq_iqs5xx, TRACKPAD_PROFILES_DEFINE)
+
+#define TRACKPAD_CTX_ENTRY(node_id) {                                                           \
+        .dev = DEVICE_DT_GET(node_id),                                                          \
+        .profiles = TRACKPAD_PROFILES_NAME(node_id),                                            \
+        .profile_count = ARRAY_SIZE(TRACKPAD_PROFILES_NAME(node_id)),                           \
+    },
+
+static struct trackpad_ctx trackpad_ctxs[] = {
+    DT_FOREACH_STATUS_OKAY(azoteq_iqs5xx, TRACKPAD_CTX_ENTRY)
+};
+
+static struct trackpad_ctx *trackpad_ctx_get(const struct device *dev) {
+    for (size_t i = 0; i < ARRAY_SIZE(trackpad_ctxs); i++) {
+        if (trackpad_ctxs[i].dev == dev) {
+            return &trackpad_ctxs[i];
         }
-    } else {
+    }
+    return NULL;
+}
+
+static void trackpad_report(const struct device *dev, uint8_t type, uint16_t code, int32_t value, bool sync) {
+    int ret = input_report(dev, type, code, value, sync, K_NO_WAIT);
+    if (ret < 0) {
         return;
     }
+    iqs5xx_latency_mark(dev, IQS5XX_LAT_REPORT);
 }
 
-// FIXED: Handle gestures even when finger_count == 0
-static void trackpad_trigger_handler(const struct device *dev, const struct iqs5xx_rawdata *data) {
-    static int trigger_count = 0;
-    int64_t current_time = k_uptime_get();
+#ifdef CONFIG_IQS5XX_INPUT_BATCH
+// Reports the collected events, the last one carries the sync
+static void trackpad_batch_flush(struct trackpad_ctx *ctx) {
+    struct trackpad_batch *batch = &ctx->batch;
+
+    for (uint8_t i = 0; i < batch->len; i++) {
+        const struct trackpad_batch_event *ev = &batch->events[i];
 
-    trigger_count++;
+        trackpad_report(ctx->dev, ev->type, ev->code, ev->value, i == batch->len - 1);
+    }
+    batch->len = 0;
+}
 
-    // CRITICAL: ALWAYS process gestures immediately, regardless of finger count
-    bool has_gesture = (data->gestures0 != 0) || (data->gestures1 != 0);
-    bool finger_count_changed = (g_gesture_state.lastFingerCount != data->finger_count);
-    bool has_activity = has_gesture || finger_count_changed || (data->finger_count > 0);
+static void trackpad_batch_add(struct trackpad_ctx *ctx, uint8_t type, uint16_t code, int32_t value) {
+    struct trackpad_batch *batch = &ctx->batch;
 
-    // Check for idle state transition (5 seconds of inactivity)
-    if (!has_activity && !is_idle_mode && (current_time - last_activity_time > 5000)) {
-        is_idle_mode = true;
-        // Could add device power state change here if supported
+    for (uint8_t i = 0; i < batch->len; i++) {
+        struct trackpad_batch_event *ev = &batch->events[i];
+
+        if (ev->type != type || ev->code != code) {
+            continue;
+        }
+        if (type == INPUT_EV_REL) {
+            ev->value += value;
+            return;
+        }
+        // A button changing twice (a click) must span two reports
+        trackpad_batch_flush(ctx);
+        break;
     }
-    
-    // If we have activity and were idle, wake up
-    if (has_activity && is_idle_mode) {
-        is_idle_mode = false;
-        last_activity_time = current_time;
+
+    if (batch->len == TRACKPAD_BATCH_SIZE) {
+        trackpad_batch_flush(ctx);
     }
-    
-    // In idle mode, reduce processing frequency significantly
-    if (is_idle_mode && (current_time - last_event_time < 100)) {
-        return; // Skip processing in idle mode unless 100ms passed
+    batch->events[batch->len++] = (struct trackpad_batch_event){
+        .type = type,
+        .code = code,
+        .value = value,
+    };
+}
+#endif
+
+// Input events of gesture handlers. While a frame is dispatched they are
+// collected and reported together, the sync flag only applies outside of it.
+void send_input_event(const struct device *dev, uint8_t type, uint16_t code, int32_t value, bool sync) {
+#ifdef CONFIG_IQS5XX_INPUT_BATCH
+    struct trackpad_ctx *ctx = trackpad_ctx_get(dev);
+
+    if (ctx != NULL && ctx->batch.open) {
+        trackpad_batch_add(ctx, type, code, value);
+        return;
     }
+#endif
+
+    trackpad_report(dev, type, code, value, sync);
+}
+
+#ifdef CONFIG_IQS5XX_TYPING_GUARD
+// End of the disable while typing window, 32 bit uptime in ms
+static atomic_t typing_guard_until;
+
+static bool typing_guard_active(void) {
+    return (int32_t)((uint32_t)atomic_get(&typing_guard_until) - k_uptime_get_32()) > 0;
+}
+
+#if CONFIG_IQS5XX_TYPING_GUARD_ACTIVE_RR > 0
+// Lowers the active refresh rate for the window and restores it once the window expired
+static struct k_work_delayable typing_rr_work;
+static bool typing_rr_lowered;
+
+static void typing_rr_work_cb(struct k_work *work) {
+    bool lower = typing_guard_active();
+
+    if (lower != typing_rr_lowered) {
+        for (size_t i = 0; i < ARRAY_SIZE(trackpad_ctxs); i++) {
+            struct trackpad_ctx *ctx = &trackpad_ctxs[i];
+            struct iqs5xx_reg_config cfg;
 
-    // Rate limit ONLY movement events, NEVER gesture events
-    if (!has_gesture && !finger_count_changed && (current_time - last_event_time < 20)) {
-        return; // Skip only movement-only events
+            if (iqs5xx_get_config(ctx->dev, &cfg) < 0) {
+                continue;
+            }
+            if (lower) {
+                ctx->saved_active_rr = cfg.activeRefreshRate;
+            }
+            iqs5xx_set_refresh_rate(ctx->dev, lower ? CONFIG_IQS5XX_TYPING_GUARD_ACTIVE_RR : ctx->saved_active_rr,
+                                    cfg.idleRefreshRate);
+        }
+        typing_rr_lowered = lower;
     }
-    // Only update last_event_time for non-gesture events to avoid blocking subsequent gestures
-    if (!has_gesture) {
-        last_event_time = current_time;
+
+    if (lower) {
+        // Come back when the window, possibly extended meanwhile, runs out
+        int32_t remaining = (int32_t)((uint32_t)atomic_get(&typing_guard_until) - k_uptime_get_32());
+        k_work_reschedule(&typing_rr_work, K_MSEC(MAX(remaining, 1)));
     }
+}
+#endif
 
+// Every key press opens or extends the window
+static int trackpad_typing_listener(const zmk_event_t *eh) {
+    const struct zmk_position_state_changed *ev = as_zmk_position_state_changed(eh);
+    if (ev == NULL || !ev->state) {
+        return ZMK_EV_EVENT_BUBBLE;
+    }
 
-    // FIXED: Process gestures FIRST, before finger count logic
-    if (has_gesture) {
+    atomic_set(&typing_guard_until, (atomic_val_t)(k_uptime_get_32() + CONFIG_IQS5XX_TYPING_GUARD_MS));
 
-        // Handle single finger gestures - but avoid conflicts with multi-finger operations
-        if (data->gestures0) {
-            // Only process single finger gestures if:
-            // 1. No multi-finger operations are active, OR
-            // 2. This is a finger-lift gesture (finger_count == 0) from a single-finger session
-            bool can_process_single = !g_gesture_state.twoFingerActive && !g_gesture_state.threeFingersPressed;
-            if (can_process_single) {
-                handle_single_finger_gestures(dev, data, &g_gesture_state);
-            }
+#if CONFIG_IQS5XX_TYPING_GUARD_ACTIVE_RR > 0
+    if (!typing_rr_lowered) {
+        k_work_schedule(&typing_rr_work, K_NO_WAIT);
+    }
+#endif
+
+    return ZMK_EV_EVENT_BUBBLE;
+}
+
+ZMK_LISTENER(trackpad_typing, trackpad_typing_listener);
+ZMK_SUBSCRIPTION(trackpad_typing, zmk_position_state_changed);
+#endif
+
+// FIXED: Handle gestures even when finger_count == 0
+static void trackpad_handle_frame(struct trackpad_ctx *ctx, const struct iqs5xx_rawdata *data) {
+    const struct device *dev = ctx->dev;
+    struct gesture_state *state = &ctx->gesture;
+
+    // Profile switches take effect on frame boundaries, handlers read it without atomics
+    state->profile = atomic_ptr_get(&ctx->profile);
+    ctx->frames++;
+
+#ifdef CONFIG_IQS5XX_TYPING_GUARD
+    if (typing_guard_active()) {
+        // No taps, gestures or motion while typing, end what was in progress
+        ctx->typing_dropped++;
+        if (state->lastFingerCount != 0) {
+            gesture_recognizer_cancel(dev, state);
         }
+        motion_coalescer_reset(&ctx->coalescer);
+        return;
+    }
+#endif
+
+    // CRITICAL: ALWAYS process gestures immediately, regardless of finger count.
+    // Held back motion frames are summed and flushed with the next reported frame.
+    const struct iqs5xx_rawdata *frames[MOTION_COALESCER_MAX_OUT];
+    uint8_t count = motion_coalescer_feed(&ctx->coalescer, data, state->lastFingerCount, k_uptime_get(),
+                                          state->profile->report_interval, frames);
+    if (count == 0) {
+        ctx->rate_limited++;
+        return;
+    }
 
-        // Handle two finger gestures
-        if (data->gestures1) {
-            handle_two_finger_gestures(dev, data, &g_gesture_state);
+    // Hardware gestures, finger set hand over and the owning recognizer in one step
+    for (uint8_t i = 0; i < count; i++) {
+        gesture_recognizer_step(dev, frames[i], state);
+    }
+}
+
+/**
+ * @brief Resolves a chip setting for a profile switch. A profile overriding
+ * it remembers the value in place, which is written back once a profile
+ * without the override is selected. Otherwise the current value is kept,
+ * runtime changes through the driver API or the shell included.
+ */
+static uint16_t trackpad_profile_setting(int32_t wanted, int32_t *base, uint16_t current) {
+    if (wanted >= 0) {
+        if (*base < 0) {
+            *base = current;
         }
-        
-        // After processing gestures, don't immediately reset states to avoid conflicts
-        // State resets will happen in the finger count logic below if needed
-    }
-
-    // THEN handle finger count changes and movement
-    switch (data->finger_count) {
-        case 0:
-            // Reset all states when no fingers detected
-            // This should happen AFTER gestures are processed to avoid conflicts
-            reset_single_finger_state(&g_gesture_state);
-            reset_two_finger_state(&g_gesture_state);
-            reset_three_finger_state(&g_gesture_state);
-            break;
-
-        case 1:
-            // Only reset others if they were active
-            if (g_gesture_state.twoFingerActive) reset_two_finger_state(&g_gesture_state);
-            if (g_gesture_state.threeFingersPressed) reset_three_finger_state(&g_gesture_state);
-
-            // Handle single finger movement (but skip if gesture was already handled above)
-            // This prevents double-processing of gestures
-            if (!has_gesture) {
-                handle_single_finger_gestures(dev, data, &g_gesture_state);
-            }
-            break;
+        return wanted;
+    }
 
-        case 2:
-            // Only reset others if they were active
-            if (g_gesture_state.isDragging) reset_single_finger_state(&g_gesture_state);
-            if (g_gesture_state.threeFingersPressed) reset_three_finger_state(&g_gesture_state);
+    if (*base >= 0) {
+        current = *base;
+        *base = -1;
+    }
+    return current;
+}
 
-            // Handle two finger gestures (but hardware gestures were already handled above)
-            if (!has_gesture) {
-                handle_two_finger_gestures(dev, data, &g_gesture_state);
-            }
-            break;
+// Writes the chip settings of the selected profile. Runs on the system
+// workqueue like typing_rr_work, so the typing guard state can't change meanwhile.
+static void trackpad_profile_work_cb(struct k_work *work) {
+    struct trackpad_ctx *ctx = CONTAINER_OF(work, struct trackpad_ctx, profile_work);
+    const struct trackpad_profile *profile = atomic_ptr_get(&ctx->profile);
+    struct iqs5xx_reg_config current;
+    struct iqs5xx_reg_config wanted;
 
-        case 3:
-            // Only reset others if they were active
-            if (g_gesture_state.isDragging) reset_single_finger_state(&g_gesture_state);
-            if (g_gesture_state.twoFingerActive) reset_two_finger_state(&g_gesture_state);
-            handle_three_finger_gestures(dev, data, &g_gesture_state);
-            break;
+    if (iqs5xx_get_config(ctx->dev, &current) < 0) {
+        return;
+    }
+
+    wanted = current;
 
-        default:
-            // 4+ fingers - reset all
-            reset_single_finger_state(&g_gesture_state);
-            reset_two_finger_state(&g_gesture_state);
-            reset_three_finger_state(&g_gesture_state);
-            break;
+    uint16_t active_rr = current.activeRefreshRate;
+#if CONFIG_IQS5XX_TYPING_GUARD_ACTIVE_RR > 0
+    // The chip runs at the typing rate, switch the rate restored after the window instead
+    if (typing_rr_lowered) {
+        active_rr = ctx->saved_active_rr;
     }
+#endif
+    active_rr = trackpad_profile_setting(profile->active_rr, &ctx->base_active_rr, active_rr);
+#if CONFIG_IQS5XX_TYPING_GUARD_ACTIVE_RR > 0
+    if (typing_rr_lowered) {
+        ctx->saved_active_rr = active_rr;
+        active_rr = current.activeRefreshRate;
+    }
+#endif
+    wanted.activeRefreshRate = active_rr;
+
+    wanted.singleFingerGestureMask = trackpad_profile_setting(profile->single_finger_gestures,
+                                                              &ctx->base_single_finger_gestures,
+                                                              current.singleFingerGestureMask);
+    wanted.multiFingerGestureMask = trackpad_profile_setting(profile->multi_finger_gestures,
+                                                             &ctx->base_multi_finger_gestures,
+                                                             current.multiFingerGestureMask);
 
-    // Update finger count when it changes
-    if (g_gesture_state.lastFingerCount != data->finger_count) {
-        g_gesture_state.lastFingerCount = data->finger_count;
+    // Only the changed fields are written, nothing when the profiles agree
+    if (memcmp(&wanted, &current, sizeof(wanted)) != 0) {
+        iqs5xx_registers_init(ctx->dev, &wanted);
     }
 }
 
-static int trackpad_init(void) {
-    trackpad = DEVICE_DT_GET_ANY(azoteq_iqs5xx);
-    if (trackpad == NULL) {
+static void trackpad_profile_apply(struct trackpad_ctx *ctx, uint8_t index) {
+    struct trackpad_profile *profile = &ctx->profiles[index];
+    const struct trackpad_profile *selected = atomic_ptr_get(&ctx->profile);
+
+    // Not set up (device not ready), or already selected
+    if (selected == NULL || selected == profile) {
+        return;
+    }
+
+    atomic_ptr_set(&ctx->profile, profile);
+    k_work_submit(&ctx->profile_work);
+}
+
+int trackpad_profile_select(const struct device *dev, uint8_t index) {
+    struct trackpad_ctx *ctx = trackpad_ctx_get(dev);
+    if (ctx == NULL) {
+        return -ENODEV;
+    }
+    if (index >= ctx->profile_count) {
         return -EINVAL;
     }
-    trackpad_device = trackpad;
 
-    // Get configuration for sensitivity
-    const struct iqs5xx_config *config = trackpad->config;
+    trackpad_profile_apply(ctx, index);
+    return 0;
+}
+
+int trackpad_profile_get(const struct device *dev) {
+    struct trackpad_ctx *ctx = trackpad_ctx_get(dev);
+    const struct trackpad_profile *selected = (ctx != NULL) ? atomic_ptr_get(&ctx->profile) : NULL;
+    if (selected == NULL) {
+        return -ENODEV;
+    }
+
+    return selected - ctx->profiles;
+}
+
+int trackpad_get_stats(const struct device *dev, struct trackpad_stats *stats) {
+    const struct trackpad_ctx *ctx = trackpad_ctx_get(dev);
+    if (ctx == NULL) {
+        return -ENODEV;
+    }
+
+    *stats = (struct trackpad_stats){
+        .frames = ctx->frames,
+        .rate_limited = ctx->rate_limited,
+        .typing_dropped = ctx->typing_dropped,
+        .gestures = ctx->gesture.stats,
+    };
+    return 0;
+}
+
+int trackpad_reset_stats(const struct device *dev) {
+    struct trackpad_ctx *ctx = trackpad_ctx_get(dev);
+    if (ctx == NULL) {
+        return -ENODEV;
+    }
+
+    ctx->frames = 0;
+    ctx->rate_limited = 0;
+    ctx->typing_dropped = 0;
+    memset(&ctx->gesture.stats, 0, sizeof(ctx->gesture.stats));
+    return 0;
+}
+
+#ifdef CONFIG_IQS5XX_PROFILE_FOLLOW_LAYERS
+// The first profile listing the highest active layer wins, profile 0 otherwise
+static int trackpad_layer_listener(const zmk_event_t *eh) {
+    const uint8_t layer = zmk_keymap_highest_layer_active();
+
+    for (size_t i = 0; i < ARRAY_SIZE(trackpad_ctxs); i++) {
+        struct trackpad_ctx *ctx = &trackpad_ctxs[i];
+        uint8_t index = 0;
+
+        for (uint8_t p = 1; p < ctx->profile_count; p++) {
+            if (layer < 32 && (ctx->profiles[p].layers & BIT(layer))) {
+                index = p;
+                break;
+            }
+        }
+        trackpad_profile_apply(ctx, index);
+    }
+
+    return ZMK_EV_EVENT_BUBBLE;
+}
+
+ZMK_LISTENER(trackpad_profile, trackpad_layer_listener);
+ZMK_SUBSCRIPTION(trackpad_profile, zmk_layer_state_changed);
+#endif
 
+static void trackpad_trigger_handler(const struct device *dev, const struct iqs5xx_rawdata *data) {
+    struct trackpad_ctx *ctx = trackpad_ctx_get(dev);
+    if (ctx == NULL) {
+        return;
+    }
+
+#ifdef CONFIG_IQS5XX_INPUT_BATCH
+    ctx->batch.open = true;
+    trackpad_handle_frame(ctx, data);
+    ctx->batch.open = false;
+    trackpad_batch_flush(ctx);
+#else
+    trackpad_handle_frame(ctx, data);
+#endif
+}
+
+static int trackpad_init(void) {
     // Initialize the keyboard events system
-    int ret = trackpad_keyboard_init(trackpad_device);
+    int ret = trackpad_keyboard_init(NULL);
     if (ret < 0) {
         return ret;
     }
 
-    // Initialize gesture state with devicetree sensitivity
-    memset(&g_gesture_state, 0, sizeof(g_gesture_state));
-    g_gesture_state.mouseSensitivity = config->sensitivity;
-    
-    // Initialize activity tracking
-    last_activity_time = k_uptime_get();
-    is_idle_mode = false;
+#if defined(CONFIG_IQS5XX_TYPING_GUARD) && CONFIG_IQS5XX_TYPING_GUARD_ACTIVE_RR > 0
+    k_work_init_delayable(&typing_rr_work, typing_rr_work_cb);
+#endif
 
-    int err = iqs5xx_trigger_set(trackpad, trackpad_trigger_handler);
-    if(err) {
-        return -EINVAL;
+    for (size_t i = 0; i < ARRAY_SIZE(trackpad_ctxs); i++) {
+        struct trackpad_ctx *ctx = &trackpad_ctxs[i];
+
+        if (!device_is_ready(ctx->dev)) {
+            continue;
+        }
+
+        // Precompute every profile, motion then costs one lookup per frame and
+        // switching profiles one pointer swap
+        for (uint8_t p = 0; p < ctx->profile_count; p++) {
+            struct trackpad_profile *profile = &ctx->profiles[p];
+
+            pointer_accel_build_lut(profile->gain_lut, &profile->accel, profile->sensitivity);
+            gesture_recognizer_build_owners(profile->owners, profile->recognizer_fingers);
+        }
+
+        memset(&ctx->gesture, 0, sizeof(ctx->gesture));
+        atomic_ptr_set(&ctx->profile, &ctx->profiles[0]);
+        ctx->gesture.profile = &ctx->profiles[0];
+        k_work_init(&ctx->profile_work, trackpad_profile_work_cb);
+        ctx->base_active_rr = -1;
+        ctx->base_single_finger_gestures = -1;
+        ctx->base_multi_finger_gestures = -1;
+        gesture_recognizer_init(ctx->dev, &ctx->gesture);
+
+        int err = iqs5xx_trigger_set(ctx->dev, trackpad_trigger_handler);
+        if(err) {
+            return -EINVAL;
+        }
     }
 
     return 0;
 }
 
+#ifdef CONFIG_IQS5XX_FOLLOW_ACTIVITY
+// Suspend the trackpads with the keyboard, the chip's own low power modes cover short idle periods
+static int trackpad_activity_listener(const zmk_event_t *eh) {
+    const struct zmk_activity_state_changed *ev = as_zmk_activity_state_changed(eh);
+    if (ev == NULL) {
+        return ZMK_EV_EVENT_BUBBLE;
+    }
+
+    bool suspend = (ev->state == ZMK_ACTIVITY_SLEEP);
+#ifdef CONFIG_IQS5XX_SUSPEND_ON_IDLE
+    suspend = suspend || (ev->state == ZMK_ACTIVITY_IDLE);
+#endif
+
+    for (size_t i = 0; i < ARRAY_SIZE(trackpad_ctxs); i++) {
+        pm_device_action_run(trackpad_ctxs[i].dev,
+                             suspend ? PM_DEVICE_ACTION_SUSPEND : PM_DEVICE_ACTION_RESUME);
+    }
+
+    return ZMK_EV_EVENT_BUBBLE;
+}
+
+ZMK_LISTENER(trackpad_activity, trackpad_activity_listener);
+ZMK_SUBSCRIPTION(trackpad_activity, zmk_activity_state_changed);
+#endif
+
 SYS_INIT(trackpad_init, APPLICATION, CONFIG_APPLICATION_INIT_PRIORITY);
@@ -6,138 +6,178 @@
 #include <zmk/hid.h>
 #include <zmk/endpoints.h>
 #include <dt-bindings/zmk/keys.h>
-
-
-// Initialize the keyboard events system
-int trackpad_keyboard_init(const struct device *input_dev) {
-    return 0;
-}
-
-// FIXED: Use HID_USAGE_KEY for keyboard HID usage page
-static int send_zoom_combo(uint32_t modifier, uint32_t key, const char* description, int hold_time) {
-
-    // Clear any existing state - USE HID_USAGE_KEY
-    zmk_hid_keyboard_clear();
-    int ret = zmk_endpoints_send_report(HID_USAGE_KEY);
-    if (ret < 0) {
-        return ret;
+#include "trackpad_keyboard_events.h"
+
+// Pending keystroke sequences
+K_MSGQ_DEFINE(trackpad_action_msgq, sizeof(const struct trackpad_action_seq *),
+              CONFIG_IQS5XX_ACTION_QUEUE_SIZE, 4);
+
+// Playback state, only touched from the action work item
+static struct k_work_delayable action_work;
+static const struct trackpad_action_seq *action_current;
+static uint8_t action_step;
+
+// Zoom modifier for Ctrl + wheel zoom, requested by gesture dispatch and applied
+// by the player. Both run on the system workqueue.
+static bool zoom_hold_wanted;
+static bool zoom_held;
+
+#ifdef CONFIG_IQS5XX_HOST_MACOS
+#define ZOOM_MODIFIER   LEFT_GUI
+#else
+#define ZOOM_MODIFIER   LEFT_CONTROL
+#endif
+
+// Plays one step of the current sequence and schedules the next one
+static void trackpad_action_work_cb(struct k_work *work) {
+    if (action_current == NULL && zoom_held != zoom_hold_wanted) {
+        // Between sequences, the modifier never lands in the middle of a shortcut
+        if (zoom_hold_wanted) {
+            zmk_hid_keyboard_press(LEFT_CONTROL);
+        } else {
+            zmk_hid_keyboard_release(LEFT_CONTROL);
+        }
+        zmk_endpoints_send_report(HID_USAGE_KEY);
+        zoom_held = zoom_hold_wanted;
+        k_work_schedule(&action_work, K_NO_WAIT);
+        return;
     }
-    k_msleep(50);
 
-    // Press modifier first (if any)
-    if (modifier != 0) {
-        ret = zmk_hid_keyboard_press(modifier);
-        if (ret < 0) {
-            return ret;
+    if (action_current == NULL) {
+        if (zoom_held) {
+            return; // Queued sequences play after the modifier is released
         }
-        ret = zmk_endpoints_send_report(HID_USAGE_KEY);
-        if (ret < 0) {
-            return ret;
+        if (k_msgq_get(&trackpad_action_msgq, &action_current, K_NO_WAIT) != 0) {
+            return; // Nothing queued
         }
-        k_msleep(30);
+        action_step = 0;
     }
 
-    // Press main key
-    ret = zmk_hid_keyboard_press(key);
-    if (ret < 0) {
-        if (modifier != 0) {
-            zmk_hid_keyboard_release(modifier);
-            zmk_endpoints_send_report(HID_USAGE_KEY);
-        }
-        return ret;
+    const struct trackpad_action_step *step = &action_current->steps[action_step];
+    int ret = 0;
+
+    switch (step->op) {
+        case TRACKPAD_ACTION_PRESS:
+            ret = zmk_hid_keyboard_press(step->keycode);
+            break;
+        case TRACKPAD_ACTION_RELEASE:
+            ret = zmk_hid_keyboard_release(step->keycode);
+            break;
+        case TRACKPAD_ACTION_CLEAR:
+            zmk_hid_keyboard_clear();
+            break;
+        default:
+            break;
     }
-    ret = zmk_endpoints_send_report(HID_USAGE_KEY);
+
     if (ret < 0) {
-        return ret;
+        // Abort the sequence and leave no keys held
+        zmk_hid_keyboard_clear();
+        zmk_endpoints_send_report(HID_USAGE_KEY);
+        action_current = NULL;
+        k_work_schedule(&action_work, K_NO_WAIT);
+        return;
     }
-    k_msleep(hold_time);
 
-    // Release main key first
-    ret = zmk_hid_keyboard_release(key);
-    if (ret < 0) {
-        return ret;
+    if (step->op != TRACKPAD_ACTION_WAIT) {
+        zmk_endpoints_send_report(HID_USAGE_KEY);
     }
-    ret = zmk_endpoints_send_report(HID_USAGE_KEY);
-    if (ret < 0) {
-        return ret;
+
+    if (++action_step >= action_current->len) {
+        action_current = NULL;
     }
-    k_msleep(20);
 
-    // Release modifier (if any)
-    if (modifier != 0) {
-        ret = zmk_hid_keyboard_release(modifier);
-        if (ret < 0) {
-            return ret;
-        }
-        ret = zmk_endpoints_send_report(HID_USAGE_KEY);
-        if (ret < 0) {
-            return ret;
-        }
-        k_msleep(30);
+    // Always come back after the step delay, to pick up the next step or sequence
+    k_work_schedule(&action_work, K_MSEC(step->delay_ms));
+}
+
+int trackpad_action_enqueue(const struct trackpad_action_seq *seq) {
+    if (seq == NULL || seq->len == 0) {
+        return -EINVAL;
     }
 
-    // Final clear
-    zmk_hid_keyboard_clear();
-    ret = zmk_endpoints_send_report(HID_USAGE_KEY);
-    k_msleep(20);
+    if (k_msgq_put(&trackpad_action_msgq, &seq, K_NO_WAIT) != 0) {
+        return -ENOMEM;
+    }
 
+    // No effect while a step delay is pending, so playback timing is kept
+    k_work_schedule(&action_work, K_NO_WAIT);
     return 0;
 }
 
-// ZOOM IN with multiple fallback methods
-void send_trackpad_zoom_in(void) {
+// Initialize the keyboard events system
+int trackpad_keyboard_init(const struct device *input_dev) {
+    k_work_init_delayable(&action_work, trackpad_action_work_cb);
+    return 0;
+}
 
-    // Method 1: Ctrl + Plus (using correct keycodes)
-    send_zoom_combo(LEFT_CONTROL, EQUAL, "Ctrl+Equal(Plus)", 150);
-    k_msleep(100);
-
-    // Method 2: Ctrl + Shift + Plus (explicit plus)
-    zmk_hid_keyboard_clear();
-    zmk_endpoints_send_report(HID_USAGE_KEY);
-    k_msleep(50);
-
-    zmk_hid_keyboard_press(LEFT_CONTROL);
-    zmk_endpoints_send_report(HID_USAGE_KEY);
-    k_msleep(20);
-    zmk_hid_keyboard_press(LEFT_SHIFT);
-    zmk_endpoints_send_report(HID_USAGE_KEY);
-    k_msleep(20);
-    zmk_hid_keyboard_press(EQUAL); // Shift+Equal = Plus
-    zmk_endpoints_send_report(HID_USAGE_KEY);
-    k_msleep(150);
-
-    zmk_hid_keyboard_clear();
-    zmk_endpoints_send_report(HID_USAGE_KEY);
-    k_msleep(100);
-
-    // Method 3: Cmd+Plus for Mac compatibility
-    send_zoom_combo(LEFT_GUI, EQUAL, "Cmd+Plus(Mac)", 150);
-    k_msleep(100);
-
-    // Method 4: Try numeric keypad plus
-    send_zoom_combo(LEFT_CONTROL, KP_PLUS, "Ctrl+NumPad_Plus", 150);
+// Zoom shortcuts of the host profile use ZOOM_MODIFIER, Cmd on macOS, Ctrl elsewhere
+TRACKPAD_ACTION_SEQ_DEFINE(zoom_in_seq,
+    TRACKPAD_ACTION_COMBO(ZOOM_MODIFIER, EQUAL, 150)
+);
+
+TRACKPAD_ACTION_SEQ_DEFINE(zoom_out_seq,
+    TRACKPAD_ACTION_COMBO(ZOOM_MODIFIER, MINUS, 150)
+);
+
+// Short taps for continuous zoom, several of these play per pinch
+TRACKPAD_ACTION_SEQ_DEFINE(zoom_step_in_seq,
+    TRACKPAD_ACTION_PRESS(ZOOM_MODIFIER, 10),
+    TRACKPAD_ACTION_PRESS(EQUAL, 20),
+    TRACKPAD_ACTION_RELEASE(EQUAL, 10),
+    TRACKPAD_ACTION_RELEASE(ZOOM_MODIFIER, 10)
+);
+
+TRACKPAD_ACTION_SEQ_DEFINE(zoom_step_out_seq,
+    TRACKPAD_ACTION_PRESS(ZOOM_MODIFIER, 10),
+    TRACKPAD_ACTION_PRESS(MINUS, 20),
+    TRACKPAD_ACTION_RELEASE(MINUS, 10),
+    TRACKPAD_ACTION_RELEASE(ZOOM_MODIFIER, 10)
+);
+
+// Test sequences
+TRACKPAD_ACTION_SEQ_DEFINE(f3_seq,
+    TRACKPAD_ACTION_CLEAR(50),
+    TRACKPAD_ACTION_PRESS(F3, 100),
+    TRACKPAD_ACTION_RELEASE(F3, 20),
+    TRACKPAD_ACTION_CLEAR(20)
+);
+
+TRACKPAD_ACTION_SEQ_DEFINE(f4_seq,
+    TRACKPAD_ACTION_CLEAR(50),
+    TRACKPAD_ACTION_PRESS(F4, 100),
+    TRACKPAD_ACTION_RELEASE(F4, 20),
+    TRACKPAD_ACTION_CLEAR(20)
+);
+
+void send_trackpad_zoom_in(void) {
+    trackpad_action_enqueue(&zoom_in_seq);
 }
 
-// ZOOM OUT with multiple fallback methods
 void send_trackpad_zoom_out(void) {
+    trackpad_action_enqueue(&zoom_out_seq);
+}
 
-    // Method 1: Ctrl + Minus
-    send_zoom_combo(LEFT_CONTROL, MINUS, "Ctrl+Minus", 150);
-    k_msleep(100);
+void send_trackpad_zoom_step(bool zoom_in) {
+    // Steps beyond the queue depth are dropped, the pinch keeps producing new ones
+    trackpad_action_enqueue(zoom_in ? &zoom_step_in_seq : &zoom_step_out_seq);
+}
 
-    // Method 2: Cmd+Minus for Mac
-    send_zoom_combo(LEFT_GUI, MINUS, "Cmd+Minus(Mac)", 150);
-    k_msleep(100);
+void send_trackpad_zoom_hold(bool hold) {
+    zoom_hold_wanted = hold;
+    // No effect while a step delay is pending, the request is applied after the step
+    k_work_schedule(&action_work, K_NO_WAIT);
+}
 
-    // Method 3: Numeric keypad minus
-    send_zoom_combo(LEFT_CONTROL, KP_MINUS, "Ctrl+NumPad_Minus", 150);
+bool trackpad_zoom_held(void) {
+    return zoom_held && zoom_hold_wanted;
 }
 
 // Test functions
 void send_trackpad_f3(void) {
-    send_zoom_combo(0, F3, "F3_Test", 100);
+    trackpad_action_enqueue(&f3_seq);
 }
 
 void send_trackpad_f4(void) {
-    send_zoom_combo(0, F4, "F4_Test", 100);
+    trackpad_action_enqueue(&f4_seq);
 }
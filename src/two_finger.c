@@ -1,115 +1,117 @@
-#include <zephyr/input/input.h>
-#include <zephyr/dt-bindings/input/input-event-codes.h>
 #include <math.h>
 #include <stdlib.h>
 #include "gesture_handlers.h"
-#include "trackpad_keyboard_events.h"
-
-
-// Gesture type enumeration
-typedef enum {
-    TWO_FINGER_NONE = 0,
-    TWO_FINGER_ZOOM,
-    TWO_FINGER_VERTICAL_SCROLL,
-    TWO_FINGER_HORIZONTAL_SCROLL
-} two_finger_gesture_type_t;
-
-// Enhanced two-finger state
-struct enhanced_two_finger_state {
-    // Basic tracking
-    bool active;
-    int64_t start_time;
-    two_finger_gesture_type_t gesture_type;
-    bool gesture_locked;
-
-    // Position tracking
-    struct {
-        uint16_t x, y;
-    } start_pos[2];
-    struct {
-        uint16_t x, y;
-    } last_pos[2];
-
-    // Zoom state
-    float initial_distance;
-    float last_distance;
-    bool zoom_command_sent;
-    int stable_readings;
-
-    // Scroll state
-    float scroll_accumulator_x;
-    float scroll_accumulator_y;
-    int64_t last_scroll_time;
-
-    // Movement tracking for gesture detection
-    float total_movement_x[2];  // Total X movement for each finger
-    float total_movement_y[2];  // Total Y movement for each finger
-} static two_finger_state = {0};
+#include "gesture_recognizer.h"
+
+
+#ifdef CONFIG_IQS5XX_FIXED_POINT
+#define TF_ABS(x)               abs(x)
+#define SCROLL_ACCUM_SCALE      2
+#else
+#define TF_ABS(x)               fabsf(x)
+#define SCROLL_ACCUM_SCALE      1
+#endif
 
 // Configuration constants
 #define GESTURE_DETECTION_TIME_MS    100    // Reduced! Time to wait before deciding gesture type
-#define ZOOM_THRESHOLD_PX           100     // Distance change needed for zoom
-#define SCROLL_THRESHOLD_PX         25      // Reduced! Movement needed to start scrolling
-#define SCROLL_SENSITIVITY          3.0f    // Scroll speed multiplier
-#define ZOOM_STABILITY_THRESHOLD    15.0f   // Distance change considered stable
-#define MIN_FINGER_STRENGTH         1000    // Minimum strength for valid gesture
+#define ZOOM_STABILITY_THRESHOLD    15      // Distance change considered stable
 #define TAP_MAX_TIME_MS             200     // Reduced! Maximum time for a tap
+#define MIN_FINGER_STRENGTH         1000    // Floor under finger-strength-min for two finger gestures
+
+#ifdef CONFIG_IQS5XX_SCROLL_COAST
+// Coast velocities are hi-res wheel units per ms in Q8
+#define COAST_VELOCITY_SHIFT        8
+#define COAST_START_VELOCITY        ((CONFIG_IQS5XX_SCROLL_COAST_MIN_SPEED << COAST_VELOCITY_SHIFT) / 1000)
+// Stop once a step would move less than a quarter unit
+#define COAST_STOP_VELOCITY         ((1 << COAST_VELOCITY_SHIFT) / 4 / CONFIG_IQS5XX_SCROLL_COAST_INTERVAL_MS)
+// Fingers resting this long before lift mean no coast
+#define COAST_MAX_REST_MS           50
+#endif
 
 // Calculate distance between two points
-static float calculate_distance(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2) {
+static tf_scalar_t calculate_distance(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2) {
+#ifdef CONFIG_IQS5XX_FIXED_POINT
+    return (tf_scalar_t)gesture_isqrt(gesture_distance_sq(x2 - x1, y2 - y1));
+#else
     float dx = (float)(x2 - x1);
     float dy = (float)(y2 - y1);
     return sqrtf(dx * dx + dy * dy);
+#endif
 }
 
 // IMMEDIATE two-finger tap detection from hardware gesture
-static void handle_hardware_two_finger_tap(void) {
-    send_input_event(INPUT_EV_KEY, INPUT_BTN_1, 1, true);
-    send_input_event(INPUT_EV_KEY, INPUT_BTN_1, 0, true);
+static void handle_hardware_two_finger_tap(const struct device *dev) {
+    send_input_event(dev, INPUT_EV_KEY, INPUT_BTN_1, 1, true);
+    send_input_event(dev, INPUT_EV_KEY, INPUT_BTN_1, 0, true);
 }
 
 // Detect gesture type based on finger movement patterns
-static two_finger_gesture_type_t detect_gesture_type(const struct iqs5xx_rawdata *data) {
+static two_finger_gesture_type_t detect_gesture_type(const struct iqs5xx_rawdata *data, struct two_finger_session *tf,
+                                                      const struct trackpad_profile *profile) {
     // Calculate current positions and movements
-    float dx0 = (float)(data->fingers[0].ax - two_finger_state.start_pos[0].x);
-    float dy0 = (float)(data->fingers[0].ay - two_finger_state.start_pos[0].y);
-    float dx1 = (float)(data->fingers[1].ax - two_finger_state.start_pos[1].x);
-    float dy1 = (float)(data->fingers[1].ay - two_finger_state.start_pos[1].y);
+    tf_scalar_t dx0 = (tf_scalar_t)(data->fingers[0].ax - tf->start_pos[0].x);
+    tf_scalar_t dy0 = (tf_scalar_t)(data->fingers[0].ay - tf->start_pos[0].y);
+    tf_scalar_t dx1 = (tf_scalar_t)(data->fingers[1].ax - tf->start_pos[1].x);
+    tf_scalar_t dy1 = (tf_scalar_t)(data->fingers[1].ay - tf->start_pos[1].y);
 
     // Update total movement tracking
-    two_finger_state.total_movement_x[0] = dx0;
-    two_finger_state.total_movement_y[0] = dy0;
-    two_finger_state.total_movement_x[1] = dx1;
-    two_finger_state.total_movement_y[1] = dy1;
-
+    tf->total_movement_x[0] = dx0;
+    tf->total_movement_y[0] = dy0;
+    tf->total_movement_x[1] = dx1;
+    tf->total_movement_y[1] = dy1;
+
+#ifdef CONFIG_IQS5XX_FIXED_POINT
+    // Check if both fingers moved enough, on squared magnitudes
+    const uint32_t threshold_sq = (uint32_t)profile->scroll_threshold * profile->scroll_threshold;
+    if (gesture_distance_sq(dx0, dy0) < threshold_sq && gesture_distance_sq(dx1, dy1) < threshold_sq) {
+        return TWO_FINGER_NONE;
+    }
+#else
     // Calculate movement magnitudes
     float movement0 = sqrtf(dx0*dx0 + dy0*dy0);
     float movement1 = sqrtf(dx1*dx1 + dy1*dy1);
 
     // Check if both fingers moved enough
-    if (movement0 < SCROLL_THRESHOLD_PX && movement1 < SCROLL_THRESHOLD_PX) {
+    if (movement0 < profile->scroll_threshold && movement1 < profile->scroll_threshold) {
         return TWO_FINGER_NONE;
     }
+#endif
 
     // Calculate distance change for zoom detection
-    float current_distance = calculate_distance(
+    tf_scalar_t current_distance = calculate_distance(
         data->fingers[0].ax, data->fingers[0].ay,
         data->fingers[1].ax, data->fingers[1].ay
     );
-    float distance_change = fabsf(current_distance - two_finger_state.initial_distance);
+    tf_scalar_t distance_change = TF_ABS(current_distance - tf->initial_distance);
+
+#ifdef CONFIG_IQS5XX_FIXED_POINT
+    int32_t dot_product = gesture_dot(dx0, dy0, dx1, dy1);
+#else
+    float dot_product = dx0*dx1 + dy0*dy1;
+#endif
 
     // Check for zoom gesture (fingers moving apart/together)
-    if (distance_change > ZOOM_THRESHOLD_PX) {
+    if (distance_change > profile->zoom_threshold) {
         // Additional check: fingers should move in opposite directions for zoom
-        float dot_product = dx0*dx1 + dy0*dy1;
         if (dot_product < 0) {  // Opposite directions
             return TWO_FINGER_ZOOM;
         }
     }
 
     // Check for scroll gestures (fingers moving in same direction)
-    float dot_product = dx0*dx1 + dy0*dy1;
     if (dot_product > 0) {  // Same direction
+#ifdef CONFIG_IQS5XX_FIXED_POINT
+        // Compare summed movement, |sum_dy| > |sum_dx| * 1.5 without halving
+        int32_t sum_dx = abs(dx0 + dx1);
+        int32_t sum_dy = abs(dy0 + dy1);
+
+        // Determine if horizontal or vertical scroll
+        if (2 * sum_dy > 3 * sum_dx) {
+            return TWO_FINGER_VERTICAL_SCROLL;
+        } else if (2 * sum_dx > 3 * sum_dy) {
+            return TWO_FINGER_HORIZONTAL_SCROLL;
+        }
+#else
         // Calculate average movement
         float avg_dx = (dx0 + dx1) / 2.0f;
         float avg_dy = (dy0 + dy1) / 2.0f;
@@ -120,152 +122,319 @@ static two_finger_gesture_type_t detect_gesture_type(const struct iqs5xx_rawdata
         } else if (fabsf(avg_dx) > fabsf(avg_dy) * 1.5f) {
             return TWO_FINGER_HORIZONTAL_SCROLL;
         }
+#endif
     }
 
     return TWO_FINGER_NONE;
 }
 
+#ifdef CONFIG_IQS5XX_ZOOM_CONTINUOUS
+// Emits a single zoom step through the configured host output
+static void zoom_step(const struct device *dev, struct two_finger_session *tf, bool zoom_in) {
+#ifdef CONFIG_IQS5XX_ZOOM_CTRL_WHEEL
+#ifdef CONFIG_IQS5XX_SCROLL_HIRES
+    // One whole detent, the host divides wheel units by the resolution multiplier
+    const int32_t detent = CONFIG_IQS5XX_SCROLL_HIRES_MULTIPLIER;
+#else
+    const int32_t detent = 1;
+#endif
+
+    if (!tf->zoom_modifier_held) {
+        // Held until the session ends
+        send_trackpad_zoom_hold(true);
+        tf->zoom_modifier_held = true;
+    }
+
+    // Sent by zoom_wheel_flush() once the modifier is down
+    tf->zoom_wheel_pending += zoom_in ? detent : -detent;
+#else
+    send_trackpad_zoom_step(zoom_in);
+#endif
+}
+
+#ifdef CONFIG_IQS5XX_ZOOM_CTRL_WHEEL
+// Wheel events scroll instead of zooming until the player has sent the modifier press
+static void zoom_wheel_flush(const struct device *dev, struct two_finger_session *tf) {
+    if (tf->zoom_wheel_pending != 0 && trackpad_zoom_held()) {
+        send_input_event(dev, INPUT_EV_REL, INPUT_REL_WHEEL, tf->zoom_wheel_pending, true);
+        tf->zoom_wheel_pending = 0;
+    }
+}
+#endif
+
+// Handle zoom gesture, one step per CONFIG_IQS5XX_ZOOM_STEP_DISTANCE of spread change
+static void handle_zoom_gesture(const struct device *dev, const struct iqs5xx_rawdata *data,
+                                struct two_finger_session *tf, const struct trackpad_profile *profile) {
+    tf_scalar_t current_distance = calculate_distance(
+        data->fingers[0].ax, data->fingers[0].ay,
+        data->fingers[1].ax, data->fingers[1].ay
+    );
+    tf->last_distance = current_distance;
+
+    while (current_distance - tf->zoom_reference >= CONFIG_IQS5XX_ZOOM_STEP_DISTANCE) {
+        zoom_step(dev, tf, true);
+        tf->zoom_reference += CONFIG_IQS5XX_ZOOM_STEP_DISTANCE;
+    }
+    while (tf->zoom_reference - current_distance >= CONFIG_IQS5XX_ZOOM_STEP_DISTANCE) {
+        zoom_step(dev, tf, false);
+        tf->zoom_reference -= CONFIG_IQS5XX_ZOOM_STEP_DISTANCE;
+    }
+#ifdef CONFIG_IQS5XX_ZOOM_CTRL_WHEEL
+    zoom_wheel_flush(dev, tf);
+#endif
+}
+#else
 // Handle zoom gesture
-static void handle_zoom_gesture(const struct iqs5xx_rawdata *data) {
-    if (two_finger_state.zoom_command_sent) {
+static void handle_zoom_gesture(const struct device *dev, const struct iqs5xx_rawdata *data,
+                                struct two_finger_session *tf, const struct trackpad_profile *profile) {
+    if (tf->zoom_command_sent) {
         return;  // Already sent zoom command this session
     }
 
-    float current_distance = calculate_distance(
+    tf_scalar_t current_distance = calculate_distance(
         data->fingers[0].ax, data->fingers[0].ay,
         data->fingers[1].ax, data->fingers[1].ay
     );
 
-    float distance_change = current_distance - two_finger_state.initial_distance;
-    float distance_delta = current_distance - two_finger_state.last_distance;
-    two_finger_state.last_distance = current_distance;
+    tf_scalar_t distance_change = current_distance - tf->initial_distance;
+    tf_scalar_t distance_delta = current_distance - tf->last_distance;
+    tf->last_distance = current_distance;
 
     // Check for stability
-    if (fabsf(distance_delta) < ZOOM_STABILITY_THRESHOLD) {
-        two_finger_state.stable_readings++;
+    if (TF_ABS(distance_delta) < ZOOM_STABILITY_THRESHOLD) {
+        tf->stable_readings++;
     } else {
-        two_finger_state.stable_readings = 0;
+        tf->stable_readings = 0;
     }
 
     // Send zoom command if stable enough
-    if (two_finger_state.stable_readings >= 1 || fabsf(distance_change) > ZOOM_THRESHOLD_PX * 2) {
+    if (tf->stable_readings >= 1 || TF_ABS(distance_change) > profile->zoom_threshold * 2) {
         if (distance_change > 0) {
             send_trackpad_zoom_in();
         } else {
             send_trackpad_zoom_out();
         }
-        two_finger_state.zoom_command_sent = true;
+        tf->zoom_command_sent = true;
     }
 }
+#endif
+
+#ifdef CONFIG_IQS5XX_SCROLL_HIRES
+// Emits the scroll movement of a frame in hi-res wheel units, one detent being
+// CONFIG_IQS5XX_SCROLL_HIRES_MULTIPLIER units, and carries the remainder over
+static void handle_hires_scroll(const struct device *dev, struct two_finger_session *tf,
+                                tf_scalar_t step, int64_t current_time) {
+    const int32_t report_distance = SCROLL_REPORT_DISTANCE * SCROLL_ACCUM_SCALE;
+    uint16_t code = (tf->gesture_type == TWO_FINGER_HORIZONTAL_SCROLL) ? INPUT_REL_HWHEEL : INPUT_REL_WHEEL;
+
+    tf->scroll_hires_accum += step * CONFIG_IQS5XX_SCROLL_HIRES_MULTIPLIER;
+    int32_t units = (int32_t)(tf->scroll_hires_accum / report_distance);
+    tf->scroll_hires_accum -= units * report_distance;
+
+    if (units != 0) {
+        send_input_event(dev, INPUT_EV_REL, code, -units, true);
+    }
+
+#ifdef CONFIG_IQS5XX_SCROLL_COAST
+    // Smoothed velocity for the coast after lift
+    int32_t dt = CLAMP((int32_t)(current_time - tf->last_scroll_time), 1, 100);
+    int32_t velocity = (units * (1 << COAST_VELOCITY_SHIFT)) / dt;
+    tf->scroll_velocity = (tf->scroll_velocity * 3 + velocity) / 4;
+#endif
+    tf->last_scroll_time = current_time;
+}
+#endif
+
+#ifdef CONFIG_IQS5XX_SCROLL_COAST
+static void scroll_coast_step(struct gesture_timer *timer) {
+    struct scroll_coast *coast = CONTAINER_OF(timer, struct scroll_coast, timer);
+
+    coast->residual += coast->velocity * CONFIG_IQS5XX_SCROLL_COAST_INTERVAL_MS;
+    int32_t units = coast->residual / (1 << COAST_VELOCITY_SHIFT);
+    coast->residual -= units * (1 << COAST_VELOCITY_SHIFT);
+
+    if (units != 0) {
+        send_input_event(coast->dev, INPUT_EV_REL, coast->code, -units, true);
+    }
+
+    coast->velocity = (coast->velocity * CONFIG_IQS5XX_SCROLL_COAST_DECAY) / 256;
+    if (abs(coast->velocity) < COAST_STOP_VELOCITY) {
+        coast->velocity = 0;
+        return;
+    }
+
+    gesture_timer_start(timer, CONFIG_IQS5XX_SCROLL_COAST_INTERVAL_MS);
+}
+
+// Starts coasting with the scroll velocity at lift, if fast and still moving
+static void scroll_coast_start(struct gesture_state *state, const struct two_finger_session *tf) {
+    struct scroll_coast *coast = &state->scrollCoast;
+
+    if (tf->gesture_type != TWO_FINGER_VERTICAL_SCROLL && tf->gesture_type != TWO_FINGER_HORIZONTAL_SCROLL) {
+        return;
+    }
+    if (abs(tf->scroll_velocity) < COAST_START_VELOCITY ||
+        gesture_uptime_get() - tf->last_scroll_time > COAST_MAX_REST_MS) {
+        return;
+    }
+
+    coast->code = (tf->gesture_type == TWO_FINGER_HORIZONTAL_SCROLL) ? INPUT_REL_HWHEEL : INPUT_REL_WHEEL;
+    coast->velocity = tf->scroll_velocity;
+    coast->residual = 0;
+    gesture_timer_start(&coast->timer, CONFIG_IQS5XX_SCROLL_COAST_INTERVAL_MS);
+}
+
+static void two_finger_init(const struct device *dev, struct gesture_state *state) {
+    state->scrollCoast.dev = dev;
+    gesture_timer_init(&state->scrollCoast.timer, scroll_coast_step);
+}
+
+// Any touch stops a running coast
+static void two_finger_touch(const struct device *dev, struct gesture_state *state) {
+    if (state->scrollCoast.velocity != 0) {
+        gesture_timer_stop(&state->scrollCoast.timer);
+        state->scrollCoast.velocity = 0;
+    }
+}
+#endif
 
 // Handle scroll gesture
-static void handle_scroll_gesture(const struct iqs5xx_rawdata *data) {
-    int64_t current_time = k_uptime_get();
+static void handle_scroll_gesture(const struct device *dev, const struct iqs5xx_rawdata *data,
+                                  struct two_finger_session *tf, const struct trackpad_profile *profile) {
+    int64_t current_time = gesture_uptime_get();
 
+#ifndef CONFIG_IQS5XX_SCROLL_HIRES
     // Rate limit scrolling to prevent too many events
-    if (current_time - two_finger_state.last_scroll_time < 50) {
+    if (current_time - tf->last_scroll_time < 50) {
         return;
     }
-
+#endif
+
+#ifdef CONFIG_IQS5XX_FIXED_POINT
+    // Summed movement of both fingers is twice the average, i.e. half pixels
+    int32_t dx = (data->fingers[0].ax - tf->last_pos[0].x) +
+                 (data->fingers[1].ax - tf->last_pos[1].x);
+    int32_t dy = (data->fingers[0].ay - tf->last_pos[0].y) +
+                 (data->fingers[1].ay - tf->last_pos[1].y);
+
+    tf_scalar_t step_x = dx * profile->scroll_sensitivity;
+    tf_scalar_t step_y = dy * profile->scroll_sensitivity;
+#else
     // Calculate average movement since last position
-    float dx = ((float)(data->fingers[0].ax - two_finger_state.last_pos[0].x) +
-                (float)(data->fingers[1].ax - two_finger_state.last_pos[1].x)) / 2.0f;
-    float dy = ((float)(data->fingers[0].ay - two_finger_state.last_pos[0].y) +
-                (float)(data->fingers[1].ay - two_finger_state.last_pos[1].y)) / 2.0f;
+    float dx = ((float)(data->fingers[0].ax - tf->last_pos[0].x) +
+                (float)(data->fingers[1].ax - tf->last_pos[1].x)) / 2.0f;
+    float dy = ((float)(data->fingers[0].ay - tf->last_pos[0].y) +
+                (float)(data->fingers[1].ay - tf->last_pos[1].y)) / 2.0f;
 
-    // Accumulate scroll movement
-    two_finger_state.scroll_accumulator_x += dx * SCROLL_SENSITIVITY;
-    two_finger_state.scroll_accumulator_y += dy * SCROLL_SENSITIVITY;
+    tf_scalar_t step_x = dx * profile->scroll_sensitivity;
+    tf_scalar_t step_y = dy * profile->scroll_sensitivity;
+#endif
 
+    // Accumulate scroll movement
+    tf->scroll_accumulator_x += step_x;
+    tf->scroll_accumulator_y += step_y;
+
+#ifdef CONFIG_IQS5XX_SCROLL_HIRES
+    // Every frame reports its share, the accumulators only serve the tap check
+    handle_hires_scroll(dev, tf, (tf->gesture_type == TWO_FINGER_HORIZONTAL_SCROLL) ? step_x : step_y,
+                        current_time);
+#else
     // Send scroll events when accumulator exceeds threshold
     int scroll_x = 0, scroll_y = 0;
+    const int32_t report_distance = SCROLL_REPORT_DISTANCE * SCROLL_ACCUM_SCALE;
 
-    if (two_finger_state.gesture_type == TWO_FINGER_HORIZONTAL_SCROLL) {
-        if (fabsf(two_finger_state.scroll_accumulator_x) >= SCROLL_REPORT_DISTANCE) {
-            scroll_x = (int)(two_finger_state.scroll_accumulator_x / SCROLL_REPORT_DISTANCE);
-            two_finger_state.scroll_accumulator_x -= scroll_x * SCROLL_REPORT_DISTANCE;
+    if (tf->gesture_type == TWO_FINGER_HORIZONTAL_SCROLL) {
+        if (TF_ABS(tf->scroll_accumulator_x) >= report_distance) {
+            scroll_x = (int)(tf->scroll_accumulator_x / report_distance);
+            tf->scroll_accumulator_x -= scroll_x * report_distance;
 
-            send_input_event(INPUT_EV_REL, INPUT_REL_HWHEEL, -scroll_x, true);
-            two_finger_state.last_scroll_time = current_time;
+            send_input_event(dev, INPUT_EV_REL, INPUT_REL_HWHEEL, -scroll_x, true);
+            tf->last_scroll_time = current_time;
         }
-    } else if (two_finger_state.gesture_type == TWO_FINGER_VERTICAL_SCROLL) {
-        if (fabsf(two_finger_state.scroll_accumulator_y) >= SCROLL_REPORT_DISTANCE) {
-            scroll_y = (int)(two_finger_state.scroll_accumulator_y / SCROLL_REPORT_DISTANCE);
-            two_finger_state.scroll_accumulator_y -= scroll_y * SCROLL_REPORT_DISTANCE;
+    } else if (tf->gesture_type == TWO_FINGER_VERTICAL_SCROLL) {
+        if (TF_ABS(tf->scroll_accumulator_y) >= report_distance) {
+            scroll_y = (int)(tf->scroll_accumulator_y / report_distance);
+            tf->scroll_accumulator_y -= scroll_y * report_distance;
 
-            send_input_event(INPUT_EV_REL, INPUT_REL_WHEEL, -scroll_y, true);
-            two_finger_state.last_scroll_time = current_time;
+            send_input_event(dev, INPUT_EV_REL, INPUT_REL_WHEEL, -scroll_y, true);
+            tf->last_scroll_time = current_time;
         }
     }
+#endif
 
     // Update last positions
-    two_finger_state.last_pos[0].x = data->fingers[0].ax;
-    two_finger_state.last_pos[0].y = data->fingers[0].ay;
-    two_finger_state.last_pos[1].x = data->fingers[1].ax;
-    two_finger_state.last_pos[1].y = data->fingers[1].ay;
+    tf->last_pos[0].x = data->fingers[0].ax;
+    tf->last_pos[0].y = data->fingers[0].ay;
+    tf->last_pos[1].x = data->fingers[1].ax;
+    tf->last_pos[1].y = data->fingers[1].ay;
 }
 
+static void two_finger_end(const struct device *dev, struct gesture_state *state, bool lifted);
+
 void handle_two_finger_gestures(const struct device *dev, const struct iqs5xx_rawdata *data, struct gesture_state *state) {
+    struct two_finger_session *tf = &state->twoFinger;
+
     if (data->finger_count != 2) {
         return;
     }
 
     // IMMEDIATE HARDWARE GESTURE HANDLING - Check first for instant response
     if (data->gestures1 & GESTURE_TWO_FINGER_TAP) {
-        handle_hardware_two_finger_tap();
+        handle_hardware_two_finger_tap(dev);
         return; // Handle tap immediately, don't process other gestures
     }
 
-    // ALSO check for immediate tap if fingers are very stable
-    if (!two_finger_state.active) {
-        // If this is the very first reading and fingers are close together,
-        // it's likely a tap intention - be more aggressive
-        float initial_distance = calculate_distance(
-            data->fingers[0].ax, data->fingers[0].ay,
-            data->fingers[1].ax, data->fingers[1].ay
-        );
-
-    }
-
     // Ensure we have two valid finger readings
     if (data->fingers[0].strength == 0 || data->fingers[1].strength == 0) {
         return;
     }
 
-    // Check minimum strength requirement
-    if (data->fingers[0].strength < MIN_FINGER_STRENGTH ||
-        data->fingers[1].strength < MIN_FINGER_STRENGTH) {
+    // The palm filter's limit, but never below the built-in floor
+    const uint16_t strength_min = MAX(MIN_FINGER_STRENGTH, state->profile->finger_strength_min);
+    if (data->fingers[0].strength < strength_min || data->fingers[1].strength < strength_min) {
         return;
     }
 
-    int64_t current_time = k_uptime_get();
+    int64_t current_time = gesture_uptime_get();
+    const uint8_t id0 = contact_tracker_get(&state->contacts, 0)->id;
+    const uint8_t id1 = contact_tracker_get(&state->contacts, 1)->id;
+
+    // A finger was swapped without the count changing, start over with the new pair
+    if (tf->active && (tf->contact_ids[0] != id0 || tf->contact_ids[1] != id1)) {
+        two_finger_end(dev, state, false);
+    }
 
     // Initialize two-finger session if just started
-    if (!two_finger_state.active) {
-        two_finger_state.active = true;
-        two_finger_state.start_time = current_time;
-        two_finger_state.gesture_type = TWO_FINGER_NONE;
-        two_finger_state.gesture_locked = false;
-        two_finger_state.zoom_command_sent = false;
-        two_finger_state.stable_readings = 0;
-        two_finger_state.last_scroll_time = current_time;
+    if (!tf->active) {
+        tf->active = true;
+        tf->contact_ids[0] = id0;
+        tf->contact_ids[1] = id1;
+        tf->start_time = current_time;
+        tf->gesture_type = TWO_FINGER_NONE;
+        tf->gesture_locked = false;
+        tf->zoom_command_sent = false;
+        tf->stable_readings = 0;
+        tf->last_scroll_time = current_time;
 
         // Store initial positions
-        two_finger_state.start_pos[0].x = two_finger_state.last_pos[0].x = data->fingers[0].ax;
-        two_finger_state.start_pos[0].y = two_finger_state.last_pos[0].y = data->fingers[0].ay;
-        two_finger_state.start_pos[1].x = two_finger_state.last_pos[1].x = data->fingers[1].ax;
-        two_finger_state.start_pos[1].y = two_finger_state.last_pos[1].y = data->fingers[1].ay;
+        tf->start_pos[0].x = tf->last_pos[0].x = data->fingers[0].ax;
+        tf->start_pos[0].y = tf->last_pos[0].y = data->fingers[0].ay;
+        tf->start_pos[1].x = tf->last_pos[1].x = data->fingers[1].ax;
+        tf->start_pos[1].y = tf->last_pos[1].y = data->fingers[1].ay;
 
         // Calculate initial distance for zoom detection
-        two_finger_state.initial_distance = calculate_distance(
+        tf->initial_distance = calculate_distance(
             data->fingers[0].ax, data->fingers[0].ay,
             data->fingers[1].ax, data->fingers[1].ay
         );
-        two_finger_state.last_distance = two_finger_state.initial_distance;
+        tf->last_distance = tf->initial_distance;
+#ifdef CONFIG_IQS5XX_ZOOM_CONTINUOUS
+        tf->zoom_reference = tf->initial_distance;
+#endif
 
         // Reset scroll accumulators
-        two_finger_state.scroll_accumulator_x = 0;
-        two_finger_state.scroll_accumulator_y = 0;
+        tf->scroll_accumulator_x = 0;
+        tf->scroll_accumulator_y = 0;
 
         // Update legacy state for compatibility
         state->twoFingerActive = true;
@@ -278,7 +447,7 @@ void handle_two_finger_gestures(const struct device *dev, const struct iqs5xx_ra
         return;
     }
 
-    int64_t time_since_start = current_time - two_finger_state.start_time;
+    int64_t time_since_start = current_time - tf->start_time;
 
     // Wait for stabilization before detecting gesture type
     if (time_since_start < GESTURE_DETECTION_TIME_MS) {
@@ -286,22 +455,22 @@ void handle_two_finger_gestures(const struct device *dev, const struct iqs5xx_ra
     }
 
     // Detect gesture type if not already locked
-    if (!two_finger_state.gesture_locked && two_finger_state.gesture_type == TWO_FINGER_NONE) {
-        two_finger_state.gesture_type = detect_gesture_type(data);
-        if (two_finger_state.gesture_type != TWO_FINGER_NONE) {
-            two_finger_state.gesture_locked = true;
+    if (!tf->gesture_locked && tf->gesture_type == TWO_FINGER_NONE) {
+        tf->gesture_type = detect_gesture_type(data, tf, state->profile);
+        if (tf->gesture_type != TWO_FINGER_NONE) {
+            tf->gesture_locked = true;
         }
     }
 
     // Handle the specific gesture
-    switch (two_finger_state.gesture_type) {
+    switch (tf->gesture_type) {
         case TWO_FINGER_ZOOM:
-            handle_zoom_gesture(data);
+            handle_zoom_gesture(dev, data, tf, state->profile);
             break;
 
         case TWO_FINGER_VERTICAL_SCROLL:
         case TWO_FINGER_HORIZONTAL_SCROLL:
-            handle_scroll_gesture(data);
+            handle_scroll_gesture(dev, data, tf, state->profile);
             break;
 
         default:
@@ -310,27 +479,67 @@ void handle_two_finger_gestures(const struct device *dev, const struct iqs5xx_ra
     }
 }
 
-void reset_two_finger_state(struct gesture_state *state) {
-    if (two_finger_state.active) {
+// Ends the session, with the lift actions (fallback tap, coast) if the fingers were lifted
+static void two_finger_end(const struct device *dev, struct gesture_state *state, bool lifted) {
+    struct two_finger_session *tf = &state->twoFinger;
+
+    if (tf->active && lifted) {
         // Only handle fallback tap if:
         // 1. No other gesture was performed 
         // 2. It was quick enough
         // 3. No significant scroll accumulation occurred
-        bool no_significant_scroll = (fabsf(two_finger_state.scroll_accumulator_x) < 10.0f && 
-                                      fabsf(two_finger_state.scroll_accumulator_y) < 10.0f);
+        bool no_significant_scroll = (TF_ABS(tf->scroll_accumulator_x) < 10 * SCROLL_ACCUM_SCALE &&
+                                      TF_ABS(tf->scroll_accumulator_y) < 10 * SCROLL_ACCUM_SCALE);
         
-        if (!two_finger_state.gesture_locked &&
-            k_uptime_get() - two_finger_state.start_time < TAP_MAX_TIME_MS &&
+        if (!tf->gesture_locked &&
+            gesture_uptime_get() - tf->start_time < TAP_MAX_TIME_MS &&
             no_significant_scroll) {
-            send_input_event(INPUT_EV_KEY, INPUT_BTN_1, 1, true);
-            send_input_event(INPUT_EV_KEY, INPUT_BTN_1, 0, true);
+            send_input_event(dev, INPUT_EV_KEY, INPUT_BTN_1, 1, true);
+            send_input_event(dev, INPUT_EV_KEY, INPUT_BTN_1, 0, true);
         }
 
+#ifdef CONFIG_IQS5XX_SCROLL_COAST
+        scroll_coast_start(state, tf);
+#endif
+    }
+
+    if (tf->active) {
+#ifdef CONFIG_IQS5XX_ZOOM_CTRL_WHEEL
+        if (tf->zoom_modifier_held) {
+            zoom_wheel_flush(dev, tf);
+            send_trackpad_zoom_hold(false);
+        }
+#endif
+
         // Clear enhanced state
-        memset(&two_finger_state, 0, sizeof(two_finger_state));
+        memset(tf, 0, sizeof(*tf));
 
         // Clear legacy state
         state->twoFingerActive = false;
         state->lastXScrollReport = 0;
     }
 }
+
+void reset_two_finger_state(const struct device *dev, struct gesture_state *state) {
+    two_finger_end(dev, state, true);
+}
+
+static void two_finger_cancel(const struct device *dev, struct gesture_state *state) {
+    two_finger_end(dev, state, false);
+}
+
+static bool two_finger_active(const struct gesture_state *state) {
+    return state->twoFingerActive;
+}
+
+const struct gesture_recognizer two_finger_recognizer = {
+    .handle = handle_two_finger_gestures,
+    .reset = reset_two_finger_state,
+    .cancel = two_finger_cancel,
+    .active = two_finger_active,
+#ifdef CONFIG_IQS5XX_SCROLL_COAST
+    .init = two_finger_init,
+    .touch = two_finger_touch,
+#endif
+    .events = GESTURE_RECOGNIZER_EV_GESTURES1,
+};
@@ -0,0 +1,108 @@
+#!/usr/bin/env python3
+# SPDX-License-Identifier: MIT
+"""Converts a CONFIG_IQS5XX_CAPTURE stream to a replay trace.
+
+The stream format is described in include/iqs5xx_capture.h. Frames are
+captured before the palm filter, so rel_from_contacts is always 0 and the
+replay sees the contacts the filter would have dropped. Keyframes carry no
+time delta, a keyframe after dropped records continues at the time of the
+last record.
+
+usage: capture_to_trace.py capture.bin [--instance N] [--start MS] > name.trace
+"""
+
+import argparse
+import sys
+
+TAG_FINGERS = 0x07
+TAG_GESTURES = 1 << 3
+TAG_SYSINFO = 1 << 4
+TAG_KEYFRAME = 1 << 5
+TAG_INSTANCE_POS = 6
+MAX_FINGERS = 5
+
+
+class Stream:
+    def __init__(self, data):
+        self.data = data
+        self.pos = 0
+
+    def byte(self):
+        if self.pos >= len(self.data):
+            raise EOFError
+        value = self.data[self.pos]
+        self.pos += 1
+        return value
+
+    def varint(self):
+        value = shift = 0
+        while True:
+            b = self.byte()
+            value |= (b & 0x7F) << shift
+            shift += 7
+            if not b & 0x80:
+                return value
+
+    def svarint(self):
+        value = self.varint()
+        return (value >> 1) ^ -(value & 1)
+
+
+def convert(data, instance, start_ms, out):
+    stream = Stream(data)
+    # Previous record of each instance: fingers and system info deltas refer to it
+    prev = {}
+    time_us = {}
+
+    out.write("# Converted from a frame capture of instance %d\n" % instance)
+    out.write("# t g0 g1 si0 si1 n rx ry rel [ax ay strength area]...\n")
+    while True:
+        try:
+            tag = stream.byte()
+        except EOFError:
+            return
+        try:
+            inst = tag >> TAG_INSTANCE_POS
+            count = tag & TAG_FINGERS
+            keyframe = bool(tag & TAG_KEYFRAME)
+            dt_us = stream.varint()
+            last = prev.get(inst, {"info": [0, 0], "fingers": [[0, 0, 0, 0]] * MAX_FINGERS})
+
+            gestures = [stream.byte(), stream.byte()] if tag & TAG_GESTURES else [0, 0]
+            info = [stream.byte(), stream.byte()] if tag & TAG_SYSINFO else list(last["info"])
+            rx = stream.svarint()
+            ry = stream.svarint()
+            fingers = []
+            for i in range(count):
+                base = [0, 0, 0] if keyframe else last["fingers"][i][:3]
+                ax, ay, strength = (base[n] + stream.svarint() for n in range(3))
+                fingers.append([ax, ay, strength, stream.byte()])
+        except EOFError:
+            sys.stderr.write("capture ends within a record\n")
+            return
+
+        time_us[inst] = time_us.get(inst, 0) + dt_us
+        prev[inst] = {"info": info, "fingers": fingers + [[0, 0, 0, 0]] * (MAX_FINGERS - count)}
+        if inst != instance:
+            continue
+
+        fields = [start_ms + time_us[inst] // 1000]
+        fields += ["0x%02x" % v for v in gestures + info]
+        fields += [count, rx, ry, 0]
+        for finger in fingers:
+            fields += finger
+        out.write(" ".join(str(f) for f in fields) + "\n")
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("capture", type=argparse.FileType("rb"))
+    parser.add_argument("--instance", type=int, default=0, help="trackpad instance (0-3)")
+    parser.add_argument("--start", type=int, default=1000, help="time of the first frame (ms)")
+    args = parser.parse_args()
+
+    convert(args.capture.read(), args.instance, args.start, sys.stdout)
+
+
+if __name__ == "__main__":
+    main()
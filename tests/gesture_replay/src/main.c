@@ -0,0 +1,110 @@
+#include <string.h>
+#include <zephyr/ztest.h>
+#include "replay.h"
+#include "gesture_platform.h"
+
+static void replay_check(const char *name, const char *trace, const char *events) {
+    struct replay_stats stats;
+    int ret = replay_run(trace, &stats);
+
+    zassert_ok(ret, "%s.trace line %u is malformed", name, stats.frames);
+
+    // Cycle count report, not checked, the host CPU does the work on native_posix
+    TC_PRINT("replay %s: %u frames, mean %llu cycles, max %u cycles per frame\n", name, stats.frames,
+             (unsigned long long)(stats.frames ? stats.cycles_total / stats.frames : 0), stats.cycles_max);
+
+    const char *log = replay_platform_log();
+    if (strcmp(log, events) != 0) {
+        TC_PRINT("--- %s.events expected\n%s--- actual\n%s---\n", name, events, log);
+        ztest_test_fail();
+    }
+}
+
+// Traces and the events they must produce, embedded by CMakeLists.txt. The
+// hires variant replays the same traces against golden/hires.
+#define REPLAY_CASE(name)                                                       \
+    ZTEST(gesture_replay, test_##name) {                                        \
+        replay_check(#name, name##_trace, name##_events);                      \
+    }
+
+static const char pointer_motion_trace[] = {
+#include "pointer_motion.trace.inc"
+    0x00,
+};
+static const char pointer_motion_events[] = {
+#include "pointer_motion.events.inc"
+    0x00,
+};
+REPLAY_CASE(pointer_motion)
+
+static const char tap_trace[] = {
+#include "tap.trace.inc"
+    0x00,
+};
+static const char tap_events[] = {
+#include "tap.events.inc"
+    0x00,
+};
+REPLAY_CASE(tap)
+
+static const char drag_trace[] = {
+#include "drag.trace.inc"
+    0x00,
+};
+static const char drag_events[] = {
+#include "drag.events.inc"
+    0x00,
+};
+REPLAY_CASE(drag)
+
+static const char scroll_trace[] = {
+#include "scroll.trace.inc"
+    0x00,
+};
+static const char scroll_events[] = {
+#include "scroll.events.inc"
+    0x00,
+};
+REPLAY_CASE(scroll)
+
+static const char pinch_trace[] = {
+#include "pinch.trace.inc"
+    0x00,
+};
+static const char pinch_events[] = {
+#include "pinch.events.inc"
+    0x00,
+};
+REPLAY_CASE(pinch)
+
+static const char two_finger_tap_trace[] = {
+#include "two_finger_tap.trace.inc"
+    0x00,
+};
+static const char two_finger_tap_events[] = {
+#include "two_finger_tap.events.inc"
+    0x00,
+};
+REPLAY_CASE(two_finger_tap)
+
+static const char swipe_trace[] = {
+#include "swipe.trace.inc"
+    0x00,
+};
+static const char swipe_events[] = {
+#include "swipe.events.inc"
+    0x00,
+};
+REPLAY_CASE(swipe)
+
+static const char palm_motion_trace[] = {
+#include "palm_motion.trace.inc"
+    0x00,
+};
+static const char palm_motion_events[] = {
+#include "palm_motion.events.inc"
+    0x00,
+};
+REPLAY_CASE(palm_motion)
+
+ZTEST_SUITE(gesture_replay, NULL, NULL, NULL, NULL, NULL);
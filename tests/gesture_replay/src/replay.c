@@ -0,0 +1,166 @@
+#include <errno.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zephyr/kernel.h>
+#include "gesture_platform.h"
+#include "gesture_recognizer.h"
+#include "motion_coalescer.h"
+#include "trackpad_profile.h"
+#include "replay.h"
+
+#define REPLAY_FIELDS_HEADER    8
+#define REPLAY_FIELDS_FINGER    4
+
+static const struct device replay_dev = {
+    .name = "replay",
+};
+
+// Devicetree defaults of the trackpad node, see TRACKPAD_PROFILE_DT
+static struct trackpad_profile replay_profile = {
+    .sensitivity = 128,
+    .accel = {
+        .curve = POINTER_ACCEL_NONE,
+        .knee_low = 2,
+        .knee_high = 16,
+        .min_gain = 128,
+        .max_gain = 128,
+    },
+    .recognizer_fingers = BIT_MASK(TRACKPAD_PROFILE_MAX_FINGERS + 1) & ~BIT(0),
+    .report_interval = 20,
+    .scroll_sensitivity = 3,
+    .scroll_threshold = 25,
+    .zoom_threshold = 100,
+    .finger_strength_min = 0,
+    .active_rr = -1,
+    .single_finger_gestures = -1,
+    .multi_finger_gestures = -1,
+};
+
+static struct gesture_state replay_state;
+static struct motion_coalescer replay_coalescer;
+
+static inline uint32_t replay_cycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    // native_posix runs the pipeline on the host CPU, k_cycle_get_32() is simulated time there
+    return (uint32_t)__builtin_ia32_rdtsc();
+#else
+    return k_cycle_get_32();
+#endif
+}
+
+// Parses one trace line, returns 0 for a frame, 1 for a blank or comment line
+static int replay_parse(const char *line, int64_t *t, struct iqs5xx_rawdata *frame) {
+    long fields[REPLAY_FIELDS_HEADER + REPLAY_FIELDS_FINGER * IQS5XX_MAX_FINGERS];
+    size_t count = 0;
+    char *end;
+
+    while (*line == ' ' || *line == '\t') {
+        line++;
+    }
+    if (*line == '#' || *line == '\n' || *line == '\0') {
+        return 1;
+    }
+
+    *t = strtoll(line, &end, 0);
+    if (end == line) {
+        return -EINVAL;
+    }
+    line = end;
+
+    for (;;) {
+        // strtol() would skip the newline too, blanks are skipped here
+        while (*line == ' ' || *line == '\t' || *line == '\r') {
+            line++;
+        }
+        if (*line == '\n' || *line == '\0' || *line == '#') {
+            break;
+        }
+
+        long value = strtol(line, &end, 0);
+        if (end == line || count == ARRAY_SIZE(fields)) {
+            return -EINVAL;
+        }
+        fields[count++] = value;
+        line = end;
+    }
+
+    if (count < REPLAY_FIELDS_HEADER || fields[4] < 0 || fields[4] > IQS5XX_MAX_FINGERS ||
+        count != REPLAY_FIELDS_HEADER + REPLAY_FIELDS_FINGER * (size_t)fields[4]) {
+        return -EINVAL;
+    }
+
+    memset(frame, 0, sizeof(*frame));
+    frame->gestures0 = fields[0];
+    frame->gestures1 = fields[1];
+    frame->system_info0 = fields[2];
+    frame->system_info1 = fields[3];
+    frame->finger_count = fields[4];
+    frame->rx = fields[5];
+    frame->ry = fields[6];
+    frame->rel_from_contacts = fields[7] != 0;
+    for (uint8_t i = 0; i < frame->finger_count; i++) {
+        const long *finger = &fields[REPLAY_FIELDS_HEADER + REPLAY_FIELDS_FINGER * i];
+
+        frame->fingers[i].ax = finger[0];
+        frame->fingers[i].ay = finger[1];
+        frame->fingers[i].strength = finger[2];
+        frame->fingers[i].area = finger[3];
+    }
+    return 0;
+}
+
+static const char *replay_next_line(const char *line) {
+    const char *end = strchr(line, '\n');
+
+    return (end != NULL) ? end + 1 : line + strlen(line);
+}
+
+int replay_run(const char *trace, struct replay_stats *stats) {
+    struct gesture_state *state = &replay_state;
+    uint32_t line_number = 0;
+    int64_t t = 0;
+
+    memset(stats, 0, sizeof(*stats));
+    replay_platform_reset(0);
+
+    pointer_accel_build_lut(replay_profile.gain_lut, &replay_profile.accel, replay_profile.sensitivity);
+    gesture_recognizer_build_owners(replay_profile.owners, replay_profile.recognizer_fingers);
+    memset(state, 0, sizeof(*state));
+    memset(&replay_coalescer, 0, sizeof(replay_coalescer));
+    state->profile = &replay_profile;
+    gesture_recognizer_init(&replay_dev, state);
+
+    for (const char *line = trace; *line != '\0'; line = replay_next_line(line)) {
+        struct iqs5xx_rawdata frame;
+        const struct iqs5xx_rawdata *frames[MOTION_COALESCER_MAX_OUT];
+
+        line_number++;
+        int ret = replay_parse(line, &t, &frame);
+        if (ret < 0) {
+            stats->frames = line_number;
+            return ret;
+        }
+        if (ret > 0) {
+            continue;
+        }
+
+        // Timers due before the frame fire first, as on the workqueue
+        replay_platform_advance(t);
+
+        // Same steps as trackpad_handle_frame()
+        uint32_t start = replay_cycles();
+        uint8_t count = motion_coalescer_feed(&replay_coalescer, &frame, state->lastFingerCount, t,
+                                              state->profile->report_interval, frames);
+        for (uint8_t i = 0; i < count; i++) {
+            gesture_recognizer_step(&replay_dev, frames[i], state);
+        }
+        uint32_t cycles = replay_cycles() - start;
+
+        stats->frames++;
+        stats->cycles_total += cycles;
+        stats->cycles_max = MAX(stats->cycles_max, cycles);
+    }
+
+    replay_platform_advance(t + REPLAY_DRAIN_MS);
+    return 0;
+}
@@ -0,0 +1,34 @@
+#pragma once
+
+#include <stdint.h>
+
+// Trace replay through the gesture pipeline, the rate limiter and recognizer
+// dispatch of trackpad.c on the default trackpad profile.
+//
+// A trace is text, one iqs5xx_rawdata frame per line in struct order after the
+// frame time, '#' starts a comment:
+//
+//   <t ms> <gestures0> <gestures1> <system_info0> <system_info1> <finger_count>
+//   <rx> <ry> <rel_from_contacts> then <ax> <ay> <strength> <area> per finger
+//
+// The input events, keystroke sequences and shortcuts the frames produce are
+// logged by replay_platform.c, one per line as "<t ms> <kind> <what>...".
+
+// Time the timers get to run out after the last frame (ms)
+#define REPLAY_DRAIN_MS     1000
+
+struct replay_stats {
+    uint32_t frames;
+    // Cycles spent in the coalescer and dispatch per frame
+    uint64_t cycles_total;
+    uint32_t cycles_max;
+};
+
+/**
+ * @brief Replays a trace on freshly initialized gesture state
+ *
+ * @param trace NUL terminated trace text
+ * @param stats Frame count and cycle counts
+ * @return 0 on success, -EINVAL with the offending line number in stats->frames on a malformed line
+ */
+int replay_run(const char *trace, struct replay_stats *stats);
@@ -0,0 +1,209 @@
+#include <stdarg.h>
+#include <stdio.h>
+#include <zephyr/sys/__assert.h>
+#include "gesture_platform.h"
+
+#define REPLAY_LOG_SIZE     16384
+#define REPLAY_TIMERS_MAX   4
+
+static int64_t replay_now;
+
+static char replay_log[REPLAY_LOG_SIZE];
+static size_t replay_log_len;
+
+static struct gesture_timer *replay_timers[REPLAY_TIMERS_MAX];
+static uint8_t replay_timer_count;
+
+// Zoom modifier state of the keystroke player, see send_trackpad_zoom_hold()
+static bool zoom_hold_wanted;
+static bool zoom_held;
+
+struct replay_name {
+    uint32_t code;
+    const char *name;
+};
+
+#define REPLAY_NAME(code) { code, #code }
+#define REPLAY_INPUT_NAME(code) { INPUT_##code, #code }
+
+static const struct replay_name replay_keys[] = {
+    REPLAY_NAME(LEFT_CONTROL),
+    REPLAY_NAME(LEFT_ALT),
+    REPLAY_NAME(LEFT_GUI),
+    REPLAY_NAME(LEFT_SHIFT),
+    REPLAY_NAME(LEFT_ARROW),
+    REPLAY_NAME(RIGHT_ARROW),
+    REPLAY_NAME(UP_ARROW),
+    REPLAY_NAME(DOWN_ARROW),
+    REPLAY_NAME(TAB),
+    REPLAY_NAME(D),
+    REPLAY_NAME(F3),
+    REPLAY_NAME(F4),
+};
+
+static const struct replay_name replay_codes[] = {
+    REPLAY_INPUT_NAME(REL_X),
+    REPLAY_INPUT_NAME(REL_Y),
+    REPLAY_INPUT_NAME(REL_WHEEL),
+    REPLAY_INPUT_NAME(REL_HWHEEL),
+    REPLAY_INPUT_NAME(BTN_0),
+    REPLAY_INPUT_NAME(BTN_1),
+    REPLAY_INPUT_NAME(BTN_2),
+};
+
+static const char *replay_name(const struct replay_name *names, size_t count, uint32_t code, char *buf,
+                               size_t len) {
+    for (size_t i = 0; i < count; i++) {
+        if (names[i].code == code) {
+            return names[i].name;
+        }
+    }
+    snprintf(buf, len, "0x%x", code);
+    return buf;
+}
+
+static void replay_log_append(const char *fmt, ...) {
+    va_list args;
+
+    va_start(args, fmt);
+    int len = vsnprintf(&replay_log[replay_log_len], sizeof(replay_log) - replay_log_len, fmt, args);
+    va_end(args);
+
+    __ASSERT(len >= 0 && replay_log_len + len < sizeof(replay_log), "event log full");
+    replay_log_len = MIN(replay_log_len + len, sizeof(replay_log) - 1);
+}
+
+int64_t gesture_uptime_get(void) {
+    return replay_now;
+}
+
+int gesture_play_keys(const struct trackpad_action_seq *seq) {
+    static const char *const ops[] = {
+        [TRACKPAD_ACTION_PRESS] = "press",
+        [TRACKPAD_ACTION_RELEASE] = "release",
+        [TRACKPAD_ACTION_CLEAR] = "clear",
+        [TRACKPAD_ACTION_WAIT] = "wait",
+    };
+    char buf[12];
+
+    replay_log_append("%lld keys", (long long)replay_now);
+    for (uint8_t i = 0; i < seq->len; i++) {
+        const struct trackpad_action_step *step = &seq->steps[i];
+
+        if (step->op == TRACKPAD_ACTION_PRESS || step->op == TRACKPAD_ACTION_RELEASE) {
+            replay_log_append(" %s:%s", ops[step->op],
+                              replay_name(replay_keys, ARRAY_SIZE(replay_keys), step->keycode, buf, sizeof(buf)));
+        } else {
+            replay_log_append(" %s", ops[step->op]);
+        }
+        replay_log_append("+%u", step->delay_ms);
+    }
+    replay_log_append("\n");
+    return 0;
+}
+
+void send_input_event(const struct device *dev, uint8_t type, uint16_t code, int32_t value, bool sync) {
+    char buf[12];
+    const char *name = replay_name(replay_codes, ARRAY_SIZE(replay_codes), code, buf, sizeof(buf));
+
+    ARG_UNUSED(dev);
+    replay_log_append("%lld %s %s %d%s\n", (long long)replay_now, type == INPUT_EV_REL ? "rel" : "key", name,
+                      value, sync ? "" : " nosync");
+}
+
+// Shortcuts of trackpad_keyboard_events.c, logged by name since their
+// sequences depend on the host profile rather than on the gesture
+void send_trackpad_f3(void) {
+    replay_log_append("%lld shortcut f3\n", (long long)replay_now);
+}
+
+void send_trackpad_f4(void) {
+    replay_log_append("%lld shortcut f4\n", (long long)replay_now);
+}
+
+void send_trackpad_zoom_in(void) {
+    replay_log_append("%lld shortcut zoom_in\n", (long long)replay_now);
+}
+
+void send_trackpad_zoom_out(void) {
+    replay_log_append("%lld shortcut zoom_out\n", (long long)replay_now);
+}
+
+void send_trackpad_zoom_step(bool zoom_in) {
+    replay_log_append("%lld shortcut zoom_step_%s\n", (long long)replay_now, zoom_in ? "in" : "out");
+}
+
+// Applied by replay_platform_advance(), as the player applies it after the frame
+void send_trackpad_zoom_hold(bool hold) {
+    zoom_hold_wanted = hold;
+}
+
+bool trackpad_zoom_held(void) {
+    return zoom_held && zoom_hold_wanted;
+}
+
+void gesture_timer_init(struct gesture_timer *timer, gesture_timer_handler_t handler) {
+    timer->handler = handler;
+    timer->armed = false;
+
+    for (uint8_t i = 0; i < replay_timer_count; i++) {
+        if (replay_timers[i] == timer) {
+            return;
+        }
+    }
+    __ASSERT(replay_timer_count < REPLAY_TIMERS_MAX, "too many timers");
+    replay_timers[replay_timer_count++] = timer;
+}
+
+void gesture_timer_start(struct gesture_timer *timer, uint32_t delay_ms) {
+    timer->due = replay_now + delay_ms;
+    timer->armed = true;
+}
+
+void gesture_timer_stop(struct gesture_timer *timer) {
+    timer->armed = false;
+}
+
+void replay_platform_reset(int64_t now) {
+    replay_now = now;
+    replay_log_len = 0;
+    replay_log[0] = '\0';
+    replay_timer_count = 0;
+    zoom_hold_wanted = false;
+    zoom_held = false;
+}
+
+// Earliest armed timer due by now, or NULL
+static struct gesture_timer *replay_timer_next(int64_t now) {
+    struct gesture_timer *next = NULL;
+
+    for (uint8_t i = 0; i < replay_timer_count; i++) {
+        struct gesture_timer *timer = replay_timers[i];
+
+        if (timer->armed && timer->due <= now && (next == NULL || timer->due < next->due)) {
+            next = timer;
+        }
+    }
+    return next;
+}
+
+void replay_platform_advance(int64_t now) {
+    struct gesture_timer *timer;
+
+    if (zoom_held != zoom_hold_wanted) {
+        zoom_held = zoom_hold_wanted;
+        replay_log_append("%lld modifier %s:LEFT_CONTROL\n", (long long)replay_now,
+                          zoom_held ? "press" : "release");
+    }
+
+    while ((timer = replay_timer_next(now)) != NULL) {
+        replay_now = MAX(replay_now, timer->due);
+        timer->armed = false;
+        timer->handler(timer);
+    }
+    replay_now = now;
+}
+
+const char *replay_platform_log(void) {
+    return replay_log;
+}
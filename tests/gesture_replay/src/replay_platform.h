@@ -0,0 +1,54 @@
+#pragma once
+
+// Gesture platform of the replay test (see gesture_platform.h). Zephyr provides
+// the device type, the util macros and the event codes as in the firmware, the
+// services are replaced: time is the trace time, timers fire when the runner
+// passes their due time, and input events and keystrokes go to an event log.
+
+#include <zephyr/device.h>
+#include <zephyr/sys/util.h>
+#include <zephyr/toolchain.h>
+#include <zephyr/dt-bindings/input/input-event-codes.h>
+#include <dt-bindings/zmk/keys.h>
+
+// Trace time of the frame being replayed (ms)
+int64_t gesture_uptime_get(void);
+
+// Logs the steps of the sequence
+int gesture_play_keys(const struct trackpad_action_seq *seq);
+
+// Logs the event
+void send_input_event(const struct device *dev, uint8_t type, uint16_t code, int32_t value, bool sync);
+
+struct gesture_timer;
+typedef void (*gesture_timer_handler_t)(struct gesture_timer *timer);
+
+// One shot timer, fired by replay_timers_run() in due time order
+struct gesture_timer {
+    gesture_timer_handler_t handler;
+    int64_t due;
+    bool armed;
+};
+
+void gesture_timer_init(struct gesture_timer *timer, gesture_timer_handler_t handler);
+
+// Fires the timer after delay_ms, replacing an expiry still pending
+void gesture_timer_start(struct gesture_timer *timer, uint32_t delay_ms);
+
+void gesture_timer_stop(struct gesture_timer *timer);
+
+/**
+ * @brief Clears the event log, the timers and the keystroke player and sets the clock
+ */
+void replay_platform_reset(int64_t now);
+
+/**
+ * @brief Advances the clock to now, firing the timers due until then and
+ * playing the keystroke requests made since the last call
+ */
+void replay_platform_advance(int64_t now);
+
+/**
+ * @brief Returns the event log, one event per line
+ */
+const char *replay_platform_log(void);